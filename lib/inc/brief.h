@@ -0,0 +1,134 @@
+#ifndef COMPUTER_VISION_BRIEF_H
+#define COMPUTER_VISION_BRIEF_H
+
+#include <descriptors.h>
+
+#include <climits>
+#include <cstdint>
+
+namespace pi::descriptors::t_brief {
+    constexpr int BR_BITS = 256;
+    constexpr int BR_PATCH_SIZE = 31;
+    constexpr float BR_SIGMA = 2.f;
+}
+
+namespace pi::descriptors {
+    template<typename T>
+    class BinaryDescriptorSet;
+
+    using BrDescriptorSet = BinaryDescriptorSet<detectors::Point>;
+    using RBrDescriptorSet = BinaryDescriptorSet<detectors::RPoint>;
+
+    BrDescriptorSet briefDescriptorSet(const std::vector<detectors::Point>& points, const Img& src,
+                                       int patchSize = t_brief::BR_PATCH_SIZE, float sigma = t_brief::BR_SIGMA,
+                                       borders::BorderTypes border = borders::BORDER_REPLICATE);
+
+    RBrDescriptorSet briefDescriptorSet(const std::vector<detectors::RPoint>& points, const Img& src,
+                                        int patchSize = t_brief::BR_PATCH_SIZE, float sigma = t_brief::BR_SIGMA,
+                                        borders::BorderTypes border = borders::BORDER_REPLICATE);
+
+    int hamming(const std::uint64_t* descriptor1, const std::uint64_t* descriptor2, int words);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const BinaryDescriptorSet<U>& set1, const BinaryDescriptorSet<U>& set2, float threshold = .8f);
+}
+
+template<typename T>
+class pi::descriptors::BinaryDescriptorSet {
+
+protected:
+    int _words;
+    std::vector<T> _points;
+    std::vector<std::uint64_t> _data;
+
+public:
+    explicit BinaryDescriptorSet(int bits = t_brief::BR_BITS, int capacity = 0)
+        : _words(bits / 64)
+    {
+        assert(bits > 0 && bits % 64 == 0);
+
+        _points.reserve(capacity);
+        _data.reserve(capacity * _words);
+    }
+
+    BinaryDescriptorSet(const BinaryDescriptorSet& set) = default;
+
+    BinaryDescriptorSet(BinaryDescriptorSet&& set) = default;
+
+    BinaryDescriptorSet& operator=(const BinaryDescriptorSet& set) = default;
+
+    BinaryDescriptorSet& operator=(BinaryDescriptorSet&& set) = default;
+
+    std::uint64_t* push(T point) {
+        _points.push_back(std::move(point));
+        _data.resize(_data.size() + _words, 0);
+
+        return row(size() - 1);
+    }
+
+    const std::uint64_t* row(int index) const {
+        assert(0 <= index && index < size());
+
+        return _data.data() + index * _words;
+    }
+
+    std::uint64_t* row(int index) {
+        assert(0 <= index && index < size());
+
+        return _data.data() + index * _words;
+    }
+
+    const T& point(int index) const {
+        return _points[index];
+    }
+
+    const std::vector<T>& points() const {
+        return _points;
+    }
+
+    int size() const {
+        return _points.size();
+    }
+
+    int words() const {
+        return _words;
+    }
+
+    int bits() const {
+        return _words * 64;
+    }
+
+    ~BinaryDescriptorSet() = default;
+};
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const BinaryDescriptorSet<U>& set1, const BinaryDescriptorSet<U>& set2, float threshold) {
+    assert(set1.words() == set2.words());
+
+    std::vector<std::pair<T, T>> matches;
+    auto words = set1.words();
+
+    for(auto i = 0, size1 = set1.size(); i < size1; i++) {
+        auto minDistance1 = INT_MAX, minDistance2 = INT_MAX;
+        auto index = 0;
+
+        for(auto j = 0, size2 = set2.size(); j < size2; j++) {
+            auto distance = descriptors::hamming(set1.row(i), set2.row(j), words);
+            if(distance < minDistance1) {
+                minDistance2 = minDistance1;
+                minDistance1 = distance;
+                index = j;
+            } else if(distance < minDistance2) {
+                minDistance2 = distance;
+            }
+        }
+
+        if((float) minDistance1 / minDistance2 <= threshold) {
+            matches.emplace_back(set1.point(i), set2.point(index));
+        }
+    }
+
+    return matches;
+}
+
+#endif //COMPUTER_VISION_BRIEF_H
@@ -0,0 +1,23 @@
+#ifndef COMPUTER_VISION_CLUSTERING_H
+#define COMPUTER_VISION_CLUSTERING_H
+
+#include <random>
+#include <vector>
+
+namespace pi::clustering::t_kmeans {
+    constexpr int KM_ITERS = 10;
+}
+
+namespace pi::clustering {
+    std::vector<float> kmeans(const float* data, int stride, int dimension, const std::vector<int>& indices,
+                              int k, std::mt19937& rand, std::vector<int>& labels, int iters = t_kmeans::KM_ITERS);
+
+    std::vector<float> kmeans(const float* data, int count, int stride, int dimension,
+                              int k, std::mt19937& rand, std::vector<int>& labels, int iters = t_kmeans::KM_ITERS);
+
+    int nearest(const float* centroids, int k, int dimension, const float* value);
+
+    float squaredDistance(const float* value1, const float* value2, int dimension);
+}
+
+#endif //COMPUTER_VISION_CLUSTERING_H
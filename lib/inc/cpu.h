@@ -0,0 +1,45 @@
+#ifndef COMPUTER_VISION_CPU_H
+#define COMPUTER_VISION_CPU_H
+
+//kernels for wider instruction sets are compiled with target attributes and chosen at runtime,
+//so the lib is built for the generic target and still uses them where the cpu has them
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PI_X86_DISPATCH 1
+#endif
+
+namespace pi::cpu {
+    bool avx2();
+
+    bool avx512f();
+
+    bool popcnt();
+}
+
+inline bool pi::cpu::avx2() {
+#ifdef PI_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool pi::cpu::avx512f() {
+#ifdef PI_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("avx512f");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool pi::cpu::popcnt() {
+#ifdef PI_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("popcnt");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#endif //COMPUTER_VISION_CPU_H
@@ -2,8 +2,11 @@
 #define COMPUTER_VISION_DESCRIPTORS_H
 
 #include <descriptors.tpp>
+#include <parallel.h>
 
 namespace pi::descriptors {
+    struct Gradients;
+
     template<typename T>
     using NormalizeFunction = std::function<Descriptor<T>(const Descriptor<T>&)>;
     using BDescriptor = Descriptor<detectors::Point>;
@@ -13,41 +16,93 @@ namespace pi::descriptors {
     using SiDescriptor = Descriptor<detectors::SPoint>;
     using SiNormalizeFunction = NormalizeFunction<detectors::SPoint>;
 
+    template<typename T>
+    using SetNormalizeFunction = std::function<void(DescriptorSet<T>&)>;
+    using BDescriptorSet = DescriptorSet<detectors::Point>;
+    using BSetNormalizeFunction = SetNormalizeFunction<detectors::Point>;
+    using RiDescriptorSet = DescriptorSet<detectors::RPoint>;
+    using RiSetNormalizeFunction = SetNormalizeFunction<detectors::RPoint>;
+    using SiDescriptorSet = DescriptorSet<detectors::SPoint>;
+    using SiSetNormalizeFunction = SetNormalizeFunction<detectors::SPoint>;
+
     constexpr int D_HISTO_SIZE = 4;
     constexpr int D_HISTO_NUMS = 4;
     constexpr int D_BINS = 8;
 
+    constexpr int ORI_BINS = 36;
     constexpr float ORI_PEAK_RATIO = .8f;
     constexpr float ORI_SIGMA_C = 1.5f;
     constexpr float MAGNITUDE_SIGMA_C = .5f;
 
+    Gradients gradients(const std::pair<Img, Img>& sobel);
+
     std::unique_ptr<float[]> histogrid(const std::pair<Img, Img>& sobel, int pR, int pC, float angle = .0f,
                                        int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS, int bins = D_BINS,
                                        float sigma = 5, borders::BorderTypes border = borders::BORDER_REPLICATE,
                                        bool is3LInterp = true);
 
+    void histogrid(float* descriptor, const std::pair<Img, Img>& sobel, int pR, int pC, float angle = .0f,
+                   int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS, int bins = D_BINS,
+                   float sigma = 5, borders::BorderTypes border = borders::BORDER_REPLICATE,
+                   bool is3LInterp = true);
+
+    void histogrid(float* descriptor, const Gradients& gradients, int pR, int pC, float angle = .0f,
+                   int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS, int bins = D_BINS,
+                   float sigma = 5, borders::BorderTypes border = borders::BORDER_REPLICATE,
+                   bool is3LInterp = true);
+
     std::vector<BDescriptor> bDescriptors(const std::vector<detectors::Point>& points, const std::pair<Img, Img>& sobel,
                                           const BNormalizeFunction& norm, int histoSize = D_HISTO_SIZE,
                                           int histoNums = D_HISTO_NUMS, int bins = D_BINS,
                                           borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = false);
 
+    BDescriptorSet bDescriptorSet(const std::vector<detectors::Point>& points, const std::pair<Img, Img>& sobel,
+                                  const BSetNormalizeFunction& norm, int histoSize = D_HISTO_SIZE,
+                                  int histoNums = D_HISTO_NUMS, int bins = D_BINS,
+                                  borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = false);
+
     std::vector<RiDescriptor> rhistogrid(const detectors::Point& point, const std::pair<Img, Img>& sobel,
                                          int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS, int bins = D_BINS,
                                          borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = false);
 
+    std::vector<RiDescriptor> rhistogrid(const detectors::Point& point, const Gradients& gradients,
+                                         int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS, int bins = D_BINS,
+                                         borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = false);
+
     std::vector<RiDescriptor> riDescriptors(const std::vector<detectors::Point>& points, const std::pair<Img, Img>& sobel,
                                             const RiNormalizeFunction& norm, int histoSize = D_HISTO_SIZE,
                                             int histoNums = D_HISTO_NUMS, int bins = D_BINS,
-                                            borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = false);
+                                            borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = false,
+                                            int threads = 1);
+
+    RiDescriptorSet riDescriptorSet(const std::vector<detectors::Point>& points, const std::pair<Img, Img>& sobel,
+                                    const RiSetNormalizeFunction& norm, int histoSize = D_HISTO_SIZE,
+                                    int histoNums = D_HISTO_NUMS, int bins = D_BINS,
+                                    borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = false,
+                                    int threads = 1);
 
     std::vector<SiDescriptor> shistogrid(detectors::SPoint point, const std::pair<Img, Img>& sobel,
                                          int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS, int bins = D_BINS,
                                          borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = true);
 
+    std::vector<SiDescriptor> shistogrid(detectors::SPoint point, const Gradients& gradients,
+                                         int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS, int bins = D_BINS,
+                                         borders::BorderTypes border = borders::BORDER_REPLICATE, bool is3LInterp = true);
+
     std::vector<SiDescriptor> siDescriptors(const std::vector<detectors::SPoint>& points, const std::vector<pyramids::Octave>& gpyramid,
                                             const SiNormalizeFunction& norm, int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS,
                                             int bins = D_BINS, borders::BorderTypes border = borders::BORDER_REPLICATE,
-                                            bool is3LInterp = true);
+                                            bool is3LInterp = true, int threads = 1);
+
+    SiDescriptorSet siDescriptorSet(const std::vector<detectors::SPoint>& points, const std::vector<pyramids::Octave>& gpyramid,
+                                    const SiSetNormalizeFunction& norm, int histoSize = D_HISTO_SIZE, int histoNums = D_HISTO_NUMS,
+                                    int bins = D_BINS, borders::BorderTypes border = borders::BORDER_REPLICATE,
+                                    bool is3LInterp = true, int threads = 1);
 }
 
+struct pi::descriptors::Gradients {
+    Img magnitude;
+    Img phi;
+};
+
 #endif // COMPUTER_VISION_DESCRIPTORS_H
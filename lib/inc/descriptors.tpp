@@ -5,20 +5,40 @@
 
 #include <type_traits>
 #include <numeric>
+#include <cstdlib>
 
 namespace pi::descriptors {
     template<typename T, class Enable = void>
     struct Descriptor;
 
+    template<typename T, class Enable = void>
+    class DescriptorSet;
+
     template<typename T>
     Descriptor<T> normalize(Descriptor<T> descriptor);
 
     template<typename T>
     Descriptor<T> trim(Descriptor<T> descriptor, float threshold = .2f);
 
+    template<typename T>
+    void normalize(DescriptorSet<T>& set);
+
+    template<typename T>
+    void trim(DescriptorSet<T>& set, float threshold = .2f);
+
+    void siftNormalize(float* data, int count, int stride, int dimension, float threshold = .2f);
+
+    template<typename T>
+    void siftNormalize(std::vector<Descriptor<T>>& descriptors, float threshold = .2f);
+
+    template<typename T>
+    void siftNormalize(DescriptorSet<T>& set, float threshold = .2f);
+
     template<typename T>
     float distance(const Descriptor<T>& descriptor1, const Descriptor<T>& descriptor2);
 
+    float distance(const float* descriptor1, const float* descriptor2, int size);
+
     template<typename T>
     std::vector<int> peaks(const Descriptor<T>& descriptor, float threshold = .8f, int nums = 2);
 
@@ -34,8 +54,34 @@ namespace pi::descriptors {
 
     template<typename T, typename U> MatchResolvedType<Descriptor<U>, T>
     match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2, float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold = .7f);
+
+    struct Match;
+
+    template<typename U>
+    std::vector<Match> matchIndices(const std::vector<Descriptor<U>>& descriptors1,
+                                    const std::vector<Descriptor<U>>& descriptors2, float threshold = .7f);
+
+    template<typename U>
+    std::vector<Match> matchIndices(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    resolve(const std::vector<Match>& matches, const std::vector<Descriptor<U>>& descriptors1,
+            const std::vector<Descriptor<U>>& descriptors2);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    resolve(const std::vector<Match>& matches, const DescriptorSet<U>& set1, const DescriptorSet<U>& set2);
 }
 
+struct pi::descriptors::Match {
+    int queryIdx;
+    int trainIdx;
+    float distance;
+    float ratio;
+};
+
 template<typename T>
 struct pi::descriptors::Descriptor<T, typename std::enable_if_t<
        std::is_base_of<pi::detectors::Point, T>::value>> {
@@ -86,6 +132,175 @@ struct pi::descriptors::Descriptor<T, typename std::enable_if_t<
     ~Descriptor() = default;
 };
 
+template<typename T>
+class pi::descriptors::DescriptorSet<T, typename std::enable_if_t<
+      std::is_base_of<pi::detectors::Point, T>::value>> {
+
+public:
+    constexpr static int ALIGNMENT = 64;
+
+protected:
+    struct Deleter {
+        void operator()(float* data) const {
+            std::free(data);
+        }
+    };
+
+    int _dimension;
+    int _stride;
+    int _capacity;
+    std::vector<T> _points;
+    std::unique_ptr<float[], Deleter> _data;
+
+public:
+    explicit DescriptorSet(int dimension, int capacity = 0)
+        : _dimension(dimension)
+        , _stride(_calcStride(dimension))
+        , _capacity(0)
+    {
+        assert(dimension > 0);
+
+        reserve(capacity);
+    }
+
+    explicit DescriptorSet(const std::vector<Descriptor<T>>& descriptors)
+        : DescriptorSet(descriptors.empty() ? 1 : descriptors.front().size, descriptors.size())
+    {
+        for(const auto &descriptor : descriptors) {
+            push(descriptor);
+        }
+    }
+
+    DescriptorSet(const DescriptorSet& set)
+        : DescriptorSet(set._dimension, set.size())
+    {
+        _points = set._points;
+        std::copy(set.data(), set.data() + set.size() * _stride, data());
+    }
+
+    DescriptorSet(DescriptorSet&& set) noexcept
+        : _dimension(set._dimension)
+        , _stride(set._stride)
+        , _capacity(set._capacity)
+        , _points(std::move(set._points))
+        , _data(std::move(set._data))
+    {
+        set._capacity = 0;
+        set._points.clear();
+    }
+
+    DescriptorSet& operator=(const DescriptorSet& set) {
+        if(this != &set) {
+            DescriptorSet copy(set);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    DescriptorSet& operator=(DescriptorSet&& set) noexcept {
+        if(this != &set) {
+            _dimension = set._dimension;
+            _stride = set._stride;
+            _capacity = set._capacity;
+            _points = std::move(set._points);
+            _data = std::move(set._data);
+
+            set._capacity = 0;
+            set._points.clear();
+        }
+        return *this;
+    }
+
+    void reserve(int capacity) {
+        if(capacity <= _capacity) return;
+
+        auto* data = static_cast<float*>(std::aligned_alloc(ALIGNMENT, sizeof(float) * _stride * capacity));
+        assert(data != nullptr);
+
+        if(_data) {
+            std::copy(_data.get(), _data.get() + size() * _stride, data);
+        }
+
+        _data.reset(data);
+        _points.reserve(capacity);
+        _capacity = capacity;
+    }
+
+    float* push(T point) {
+        if(size() == _capacity) {
+            reserve(std::max(16, 2 * _capacity));
+        }
+
+        _points.push_back(std::move(point));
+
+        auto* row = this->row(size() - 1);
+        std::fill(row, row + _stride, .0f);
+
+        return row;
+    }
+
+    void push(const Descriptor<T>& descriptor) {
+        assert(descriptor.size == _dimension);
+
+        std::copy(descriptor.data.get(), descriptor.data.get() + _dimension, push(descriptor.point));
+    }
+
+    Descriptor<T> descriptor(int index) const {
+        Descriptor<T> descriptor(point(index), _dimension);
+        std::copy(row(index), row(index) + _dimension, descriptor.data.get());
+
+        return descriptor;
+    }
+
+    const float* data() const {
+        return _data.get();
+    }
+
+    float* data() {
+        return _data.get();
+    }
+
+    const float* row(int index) const {
+        assert(0 <= index && index < size());
+
+        return _data.get() + index * _stride;
+    }
+
+    float* row(int index) {
+        assert(0 <= index && index < size());
+
+        return _data.get() + index * _stride;
+    }
+
+    const T& point(int index) const {
+        return _points[index];
+    }
+
+    const std::vector<T>& points() const {
+        return _points;
+    }
+
+    int size() const {
+        return _points.size();
+    }
+
+    int dimension() const {
+        return _dimension;
+    }
+
+    int stride() const {
+        return _stride;
+    }
+
+    ~DescriptorSet() = default;
+
+protected:
+    static int _calcStride(int dimension) {
+        auto floats = ALIGNMENT / (int) sizeof(float);
+        return (dimension + floats - 1) / floats * floats;
+    }
+};
+
 template<typename T>
 pi::descriptors::Descriptor<T> pi::descriptors::normalize(Descriptor<T> descriptor) {
     auto first = descriptor.data.get();
@@ -115,6 +330,45 @@ pi::descriptors::Descriptor<T> pi::descriptors::trim(Descriptor<T> descriptor, f
     return descriptor;
 }
 
+template<typename T>
+void pi::descriptors::normalize(DescriptorSet<T>& set) {
+    for(auto i = 0, size = set.size(), dimension = set.dimension(); i < size; i++) {
+        auto first = set.row(i);
+        auto last = first + dimension;
+
+        auto length = std::sqrt(std::accumulate(first, last, .0f, [] (auto accumulator, auto value) {
+            return accumulator + value * value;
+        }));
+
+        std::transform(first, last, first, [length] (auto value) {
+            return value / length;
+        });
+    }
+}
+
+template<typename T>
+void pi::descriptors::trim(DescriptorSet<T>& set, float threshold) {
+    for(auto i = 0, size = set.size(), dimension = set.dimension(); i < size; i++) {
+        auto first = set.row(i);
+
+        std::transform(first, first + dimension, first, [threshold] (auto value) {
+            return std::min(value, threshold);
+        });
+    }
+}
+
+template<typename T>
+void pi::descriptors::siftNormalize(std::vector<Descriptor<T>>& descriptors, float threshold) {
+    for(auto &descriptor : descriptors) {
+        siftNormalize(descriptor.data.get(), 1, descriptor.size, descriptor.size, threshold);
+    }
+}
+
+template<typename T>
+void pi::descriptors::siftNormalize(DescriptorSet<T>& set, float threshold) {
+    siftNormalize(set.data(), set.size(), set.stride(), set.dimension(), threshold);
+}
+
 template<typename T>
 std::vector<int> pi::descriptors::peaks(const Descriptor<T>& descriptor, float threshold, int nums) {
     std::vector<int> positions;
@@ -136,12 +390,7 @@ template<typename T>
 float pi::descriptors::distance(const Descriptor<T>& descriptor1, const Descriptor<T>& descriptor2) {
     assert(descriptor1.size == descriptor2.size);
 
-    auto distance = .0f;
-    for(auto i = 0; i < descriptor1.size; i++) {
-        distance += std::pow(descriptor1.data[i] - descriptor2.data[i], 2);
-    }
-
-    return distance;
+    return distance(descriptor1.data.get(), descriptor2.data.get(), descriptor1.size);
 }
 
 template<typename T, typename U>
@@ -151,24 +400,91 @@ std::vector<std::pair<T, T>> pi::descriptors::match(const std::vector<Descriptor
                                                     float threshold) {
     std::vector<std::pair<T, T>> matches;
 
-    for(const auto &descriptor1 : descriptors1) {
+    for(const auto &match : matchIndices(descriptors1, descriptors2, threshold)) {
+        matches.push_back(op(descriptors1[match.queryIdx], descriptors2[match.trainIdx]));
+    }
+
+    return matches;
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                       float threshold) {
+    return resolve<T>(matchIndices(descriptors1, descriptors2, threshold), descriptors1, descriptors2);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::descriptors::Descriptor<U>, T>
+pi::descriptors::match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                       float threshold) {
+    return match<T, U>(descriptors1, descriptors2, [](auto d1, auto d2) {
+        return std::pair<T, T>(std::move(d1), std::move(d2));
+    }, threshold);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold) {
+    return resolve<T>(matchIndices(set1, set2, threshold), set1, set2);
+}
+
+template<typename U>
+std::vector<pi::descriptors::Match> pi::descriptors::matchIndices(const std::vector<Descriptor<U>>& descriptors1,
+                                                                  const std::vector<Descriptor<U>>& descriptors2,
+                                                                  float threshold) {
+    std::vector<Match> matches;
+    if(descriptors2.empty()) return matches;
+
+    for(auto i = 0, size1 = (int) descriptors1.size(); i < size1; i++) {
         auto minDistance1 = FLT_MAX, minDistance2 = FLT_MAX;
-        auto index = 0, counter = 0;
+        auto index = 0;
 
-        for(const auto &descriptor2 : descriptors2) {
-            auto distance = descriptors::distance(descriptor1, descriptor2);
+        for(auto j = 0, size2 = (int) descriptors2.size(); j < size2; j++) {
+            auto distance = descriptors::distance(descriptors1[i], descriptors2[j]);
             if(distance < minDistance1) {
                 minDistance2 = minDistance1;
                 minDistance1 = distance;
-                index = counter;
+                index = j;
             } else if(distance < minDistance2) {
                 minDistance2 = distance;
             }
-            counter++;
         }
 
-        if(minDistance1 / minDistance2 <= threshold) {
-            matches.push_back(op(descriptor1, descriptors2[index]));
+        auto ratio = minDistance1 / minDistance2;
+        if(ratio <= threshold) {
+            matches.push_back({i, index, minDistance1, ratio});
+        }
+    }
+
+    return matches;
+}
+
+template<typename U>
+std::vector<pi::descriptors::Match> pi::descriptors::matchIndices(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2,
+                                                                  float threshold) {
+    assert(set1.dimension() == set2.dimension());
+
+    std::vector<Match> matches;
+    if(set2.size() == 0) return matches;
+
+    auto dimension = set1.dimension();
+
+    for(auto i = 0, size1 = set1.size(); i < size1; i++) {
+        auto minDistance1 = FLT_MAX, minDistance2 = FLT_MAX;
+        auto index = 0;
+
+        for(auto j = 0, size2 = set2.size(); j < size2; j++) {
+            auto distance = descriptors::distance(set1.row(i), set2.row(j), dimension);
+            if(distance < minDistance1) {
+                minDistance2 = minDistance1;
+                minDistance1 = distance;
+                index = j;
+            } else if(distance < minDistance2) {
+                minDistance2 = distance;
+            }
+        }
+
+        auto ratio = minDistance1 / minDistance2;
+        if(ratio <= threshold) {
+            matches.push_back({i, index, minDistance1, ratio});
         }
     }
 
@@ -176,19 +492,28 @@ std::vector<std::pair<T, T>> pi::descriptors::match(const std::vector<Descriptor
 }
 
 template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
-pi::descriptors::match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
-                       float threshold) {
-    return match<T, U>(descriptors1, descriptors2, [](const auto& d1, const auto& d2) {
-        return std::pair<T, T>(d1.point, d2.point);
-    }, threshold);
+pi::descriptors::resolve(const std::vector<Match>& matches, const std::vector<Descriptor<U>>& descriptors1,
+                         const std::vector<Descriptor<U>>& descriptors2) {
+    std::vector<std::pair<T, T>> points;
+    points.reserve(matches.size());
+
+    for(const auto &match : matches) {
+        points.emplace_back(descriptors1[match.queryIdx].point, descriptors2[match.trainIdx].point);
+    }
+
+    return points;
 }
 
-template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::descriptors::Descriptor<U>, T>
-pi::descriptors::match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
-                       float threshold) {
-    return match<T, U>(descriptors1, descriptors2, [](auto d1, auto d2) {
-        return std::pair<T, T>(std::move(d1), std::move(d2));
-    }, threshold);
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::resolve(const std::vector<Match>& matches, const DescriptorSet<U>& set1, const DescriptorSet<U>& set2) {
+    std::vector<std::pair<T, T>> points;
+    points.reserve(matches.size());
+
+    for(const auto &match : matches) {
+        points.emplace_back(set1.point(match.queryIdx), set2.point(match.trainIdx));
+    }
+
+    return points;
 }
 
 #endif // COMPUTER_VISION_DESCRIPTORS_TPP
@@ -2,10 +2,19 @@
 #define COMPUTER_VISION_DETECTORS_H
 
 #include <pyramid.h>
+#include <integral.h>
 
 #include <cfloat>
+#include <numeric>
 #include <vector>
 
+namespace pi::detectors::t_hessian {
+    constexpr int H_OCTAVES = 4;
+    constexpr int H_LAYERS = 4;
+    constexpr float H_THRESHOLD = 4e-4f;
+    constexpr float H_DXY_WEIGHT = .9f;
+}
+
 namespace pi::detectors {
     struct Point;
 
@@ -13,6 +22,8 @@ namespace pi::detectors {
 
     struct SPoint;
 
+    struct Budget;
+
     typedef std::function<float(int, int, int, int)> DistanceFunction;
 
     typedef std::function<float(
@@ -22,21 +33,57 @@ namespace pi::detectors {
     std::vector<Point> moravec(const Img& src, int patchSize = 5, float threshold = .03f,
                                borders::BorderTypes border = borders::BORDER_REPLICATE);
 
+    std::vector<Point> moravec(const Img& src, const Budget& budget, int patchSize = 5, float threshold = .03f,
+                               borders::BorderTypes border = borders::BORDER_REPLICATE);
+
     std::vector<Point> harris(const Img& src, int patchSize = 5, float threshold = .03f,
                               float k = .04f, borders::BorderTypes border = borders::BORDER_REPLICATE);
 
+    std::vector<Point> harris(const Img& src, const Budget& budget, int patchSize = 5, float threshold = .03f,
+                              float k = .04f, borders::BorderTypes border = borders::BORDER_REPLICATE);
+
+    std::vector<Point> fast(const Img& src, float threshold = .05f, int arc = 9, bool nonmaxSuppression = true,
+                            bool score = true);
+
+    std::vector<Point> nonMaximumSuppression(const Img& src, int patchSize, float threshold,
+                                             borders::BorderTypes border = borders::BORDER_REPLICATE);
+
     std::vector<SPoint> harris(const std::vector<pyramids::Octave>& dog, const std::vector<SPoint>& blobs,
                                float threshold = .001f, float k = .04f,
                                borders::BorderTypes border = borders::BORDER_REPLICATE);
 
+    std::vector<SPoint> harris(const std::vector<pyramids::Octave>& dog, const std::vector<SPoint>& blobs,
+                               const Budget& budget, float threshold = .001f, float k = .04f,
+                               borders::BorderTypes border = borders::BORDER_REPLICATE);
+
     std::vector<SPoint> shiTomasi(const std::vector<pyramids::Octave>& dog, const std::vector<SPoint>& blobs,
                                   float threshold = .001f, borders::BorderTypes border = borders::BORDER_REPLICATE);
 
+    std::vector<SPoint> shiTomasi(const std::vector<pyramids::Octave>& dog, const std::vector<SPoint>& blobs,
+                                  const Budget& budget, float threshold = .001f,
+                                  borders::BorderTypes border = borders::BORDER_REPLICATE);
+
     std::vector<SPoint> blobs(const std::vector<pyramids::Octave>& dog, float contrastThreshold = 5e-2f,
                               borders::BorderTypes border = borders::BORDER_REPLICATE);
 
+    std::vector<SPoint> blobs(const std::vector<pyramids::Octave>& dog, const Budget& budget,
+                              float contrastThreshold = 5e-2f, borders::BorderTypes border = borders::BORDER_REPLICATE);
+
+    std::vector<SPoint> hessian(const Img& src, int layers, int octaves = t_hessian::H_OCTAVES,
+                                float threshold = t_hessian::H_THRESHOLD);
+
+    std::vector<SPoint> hessian(const Integral& integral, int layers, int octaves = t_hessian::H_OCTAVES,
+                                float threshold = t_hessian::H_THRESHOLD);
+
+    std::vector<Point> retainBest(const std::vector<Point>& points, Size size, const Budget& budget);
+
+    std::vector<SPoint> retainBest(const std::vector<SPoint>& points, Size size, const Budget& budget);
+
     std::vector<Point> adaptiveNonMaximumSuppresion(const std::vector<Point>& points, int quantity, float radiusMax,
                                                     const DistanceFunction& distanceFunction, float coefficient = .9f);
+
+    std::vector<Point> adaptiveNonMaximumSuppresion(const std::vector<Point>& points, int quantity,
+                                                    float coefficient = .9f);
 }
 
 namespace pi::detectors::utils {
@@ -64,4 +111,9 @@ struct pi::detectors::SPoint : RPoint {
     float sigmaGlobal;
 };
 
+struct pi::detectors::Budget {
+    int maxPoints;
+    int gridSize;
+};
+
 #endif // COMPUTER_VISION_DETECTORS_H
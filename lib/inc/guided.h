@@ -0,0 +1,168 @@
+#ifndef COMPUTER_VISION_GUIDED_H
+#define COMPUTER_VISION_GUIDED_H
+
+#include <descriptors.h>
+#include <transforms.tpp>
+
+namespace pi::descriptors::t_guided {
+    constexpr float G_RADIUS = 20.f;
+    constexpr int G_MAX_CELLS = 1 << 16;
+}
+
+namespace pi::descriptors {
+    class PointGrid;
+
+    template<typename T>
+    std::vector<float> positions(const std::vector<T>& points);
+
+    template<typename U>
+    std::vector<Match> guidedMatchIndices(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2,
+                                          const transforms::Transform2d& h, float radius = t_guided::G_RADIUS,
+                                          float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    guidedMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, const transforms::Transform2d& h,
+                float radius = t_guided::G_RADIUS, float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    guidedMatch(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                const transforms::Transform2d& h, float radius = t_guided::G_RADIUS, float threshold = .7f);
+}
+
+class pi::descriptors::PointGrid {
+
+protected:
+    float _cell;
+    float _minX;
+    float _minY;
+    int _cols;
+    int _rows;
+    std::vector<float> _positions;
+    std::vector<int> _offsets;
+    std::vector<int> _indices;
+
+public:
+    PointGrid(const float* positions, int count, float cell);
+
+    template<typename T>
+    PointGrid(const std::vector<T>& points, float cell)
+        : PointGrid(descriptors::positions(points).data(), points.size(), cell)
+    {
+    }
+
+    PointGrid(const PointGrid& grid) = default;
+
+    PointGrid(PointGrid&& grid) = default;
+
+    PointGrid& operator=(const PointGrid& grid) = default;
+
+    PointGrid& operator=(PointGrid&& grid) = default;
+
+    template<typename F>
+    void forEach(float x, float y, float radius, F function) const {
+        if(_indices.empty() || !std::isfinite(x) || !std::isfinite(y)) return;
+
+        //clamped in float, a far away coordinate does not fit into int
+        auto cellOf = [this](float value, float min, int cells) {
+            return (int) std::max(.0f, std::min((float) (cells - 1), std::floor((value - min) / _cell)));
+        };
+
+        auto c1 = cellOf(x - radius, _minX, _cols);
+        auto c2 = cellOf(x + radius, _minX, _cols);
+        auto r1 = cellOf(y - radius, _minY, _rows);
+        auto r2 = cellOf(y + radius, _minY, _rows);
+
+        for(auto r = r1; r <= r2; r++) {
+            for(auto c = c1; c <= c2; c++) {
+                auto cell = r * _cols + c;
+
+                for(auto k = _offsets[cell]; k < _offsets[cell + 1]; k++) {
+                    auto index = _indices[k];
+                    if(std::hypot(_positions[2 * index] - x, _positions[2 * index + 1] - y) <= radius) {
+                        function(index);
+                    }
+                }
+            }
+        }
+    }
+
+    int size() const;
+
+    ~PointGrid() = default;
+};
+
+template<typename T>
+std::vector<float> pi::descriptors::positions(const std::vector<T>& points) {
+    std::vector<float> positions(2 * points.size());
+
+    for(auto i = 0; i < points.size(); i++) {
+        positions[2 * i] = points[i].col;
+        positions[2 * i + 1] = points[i].row;
+    }
+
+    return positions;
+}
+
+template<typename U>
+std::vector<pi::descriptors::Match> pi::descriptors::guidedMatchIndices(const DescriptorSet<U>& set1,
+                                                                        const DescriptorSet<U>& set2,
+                                                                        const transforms::Transform2d& h,
+                                                                        float radius, float threshold) {
+    assert(set1.dimension() == set2.dimension() && radius > 0);
+
+    std::vector<Match> matches;
+    PointGrid grid(set2.points(), radius);
+    auto dimension = set1.dimension();
+
+    auto mul = [](const transforms::Transform1d& h, float x, float y) {
+        return h[0] * x + h[1] * y + h[2];
+    };
+
+    for(auto i = 0, size1 = set1.size(); i < size1; i++) {
+        const auto &point = set1.point(i);
+
+        auto div = mul(h[2], point.col, point.row);
+        auto x = mul(h[0], point.col, point.row) / div;
+        auto y = mul(h[1], point.col, point.row) / div;
+
+        //points on or near the horizon line of h have no usable prediction
+        if(!std::isfinite(x) || !std::isfinite(y)) continue;
+
+        auto minDistance1 = FLT_MAX, minDistance2 = FLT_MAX;
+        auto index = -1;
+
+        grid.forEach(x, y, radius, [&](int j) {
+            auto distance = descriptors::distance(set1.row(i), set2.row(j), dimension);
+            if(distance < minDistance1 || (distance == minDistance1 && j < index)) {
+                minDistance2 = minDistance1;
+                minDistance1 = distance;
+                index = j;
+            } else if(distance < minDistance2) {
+                minDistance2 = distance;
+            }
+        });
+
+        //a single candidate in the window is kept, the predicted location already constrains it,
+        //but without a second neighbour it gets the loosest accepted ratio rather than ranking as the best
+        auto ratio = minDistance2 < FLT_MAX ? minDistance1 / minDistance2 : threshold;
+        if(index >= 0 && ratio <= threshold) {
+            matches.push_back({i, index, minDistance1, ratio});
+        }
+    }
+
+    return matches;
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::guidedMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, const transforms::Transform2d& h,
+                             float radius, float threshold) {
+    return resolve<T>(guidedMatchIndices(set1, set2, h, radius, threshold), set1, set2);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::guidedMatch(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                             const transforms::Transform2d& h, float radius, float threshold) {
+    return guidedMatch<T>(DescriptorSet<U>(descriptors1), DescriptorSet<U>(descriptors2), h, radius, threshold);
+}
+
+#endif //COMPUTER_VISION_GUIDED_H
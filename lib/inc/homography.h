@@ -2,45 +2,211 @@
 #define COMPUTER_VISION_HOMOGRAPHY_H
 
 #include <transforms.tpp>
+#include <parallel.h>
 
-#include <random>
+#include <algorithm>
+#include <cstdint>
 
 namespace pi::transforms::t_homography {
     constexpr float H_THRESHOLD = 4.5f;
     constexpr int H_ITERS = 1200;
+    constexpr float H_CONFIDENCE = .995f;
+    constexpr int H_SAMPLE = 4;
+    constexpr int H_WINDOW = 1024;
+    constexpr int H_PROSAC_GROWTH = 200000;
+    constexpr std::uint64_t H_SEED = 0x68736163;
 }
 
 namespace pi::transforms {
+    bool minimalHomography(const float* src, const float* dst, Transform2d& h);
+
+    int ransacIterations(int inliers, int total, float confidence, int sample = t_homography::H_SAMPLE);
+
+    void sampleIndices(std::uint64_t seed, int iteration, int size, int* indices, int sample = t_homography::H_SAMPLE);
+
+    template<typename T>
+    int inliersCount(const Transform2d& h, const std::vector<PPairs<T>>& matches, float threshold);
+
+    template<typename T>
+    bool minimalHomography(const std::vector<PPairs<T>>& matches, const int* indices, Transform2d& h);
+
     template<typename T>
     Transform2d homography(const std::vector<PPairs<T>>& matches,
                            float threshold = t_homography::H_THRESHOLD,
-                           int iters = t_homography::H_ITERS);
+                           int iters = t_homography::H_ITERS,
+                           float confidence = t_homography::H_CONFIDENCE,
+                           std::uint64_t seed = t_homography::H_SEED,
+                           int threads = 1);
+
+    template<typename T>
+    Transform2d prosacHomography(const std::vector<PPairs<T>>& matches,
+                                 float threshold = t_homography::H_THRESHOLD,
+                                 int iters = t_homography::H_ITERS,
+                                 float confidence = t_homography::H_CONFIDENCE,
+                                 std::uint64_t seed = t_homography::H_SEED);
+}
+
+template<typename T>
+int pi::transforms::inliersCount(const Transform2d& h, const std::vector<PPairs<T>>& matches, float threshold) {
+    return std::count_if(std::begin(matches), std::end(matches), [&](const auto& pair) {
+        return isInlier(h, pair, threshold);
+    });
+}
+
+template<typename T>
+bool pi::transforms::minimalHomography(const std::vector<PPairs<T>>& matches, const int* indices, Transform2d& h) {
+    using namespace t_homography;
+
+    float src[2 * H_SAMPLE];
+    float dst[2 * H_SAMPLE];
+
+    for(auto i = 0; i < H_SAMPLE; i++) {
+        const auto &pair = matches[indices[i]];
+
+        src[2 * i] = pair.first.col;
+        src[2 * i + 1] = pair.first.row;
+        dst[2 * i] = pair.second.col;
+        dst[2 * i + 1] = pair.second.row;
+    }
+
+    return minimalHomography(src, dst, h);
 }
 
 template<typename T>
 pi::transforms::Transform2d pi::transforms::homography(const std::vector<PPairs<T>>& matches,
-                                                       float threshold, int iters) {
-    assert(matches.size() >= 4);
+                                                       float threshold, int iters, float confidence,
+                                                       std::uint64_t seed, int threads) {
+    using namespace t_homography;
+
+    //no model can be estimated from fewer matches than a minimal sample
+    if(matches.size() < H_SAMPLE) return Transform2d{};
+
+    auto size = (int) matches.size();
+    auto bestInliersCount = 0;
+    auto bestIteration = -1;
+
+    //results of hypotheses ahead of the reduce cursor, ready[slot] holds the iteration a slot is filled for
+    std::vector<int> counts(H_WINDOW);
+    std::vector<std::atomic<int>> ready(H_WINDOW);
+    for(auto &slot : ready) {
+        slot.store(-1, std::memory_order_relaxed);
+    }
 
-    std::vector<PPairs<T>> pairs;
-    std::vector<PPairs<T>> inliers;
-    auto bestInliersCount = inliers.size();
-    std::mt19937 rand{std::random_device{}()};
+    std::atomic<int> next{0};
+    std::atomic<int> cursor{0};
+    std::atomic<int> bound{iters};
+    std::atomic_flag reducing = ATOMIC_FLAG_INIT;
 
-    for(auto i = 0; i < iters; i++) {
-        pairs.clear();
-        std::sample(std::begin(matches), std::end(matches), std::back_inserter(pairs), 4, rand);
+    //whoever holds the flag merges finished hypotheses in iteration order and tightens the bound,
+    //so iteration i is counted only if the sequential estimator would have run it
+    auto reduce = [&]() {
+        if(reducing.test_and_set(std::memory_order_acquire)) return;
+
+        for(auto i = cursor.load(std::memory_order_relaxed);
+            i < bound.load(std::memory_order_relaxed) && ready[i % H_WINDOW].load(std::memory_order_acquire) == i; i++) {
+            auto count = counts[i % H_WINDOW];
+            if(count > bestInliersCount) {
+                bestInliersCount = count;
+                bestIteration = i;
+                bound.store(std::min(bound.load(std::memory_order_relaxed), ransacIterations(count, size, confidence)),
+                            std::memory_order_relaxed);
+            }
+
+            cursor.store(i + 1, std::memory_order_release);
+        }
+
+        reducing.clear(std::memory_order_release);
+    };
+
+    //iteration i always draws the same sample and the merge is ordered, so the result does not depend on threads;
+    //workers run ahead of the merge by up to H_WINDOW hypotheses and only wait beyond that
+    parallel::run(std::max(1, threads), [&](int) {
+        for(auto i = next++; i < bound.load(std::memory_order_relaxed); i = next++) {
+            while(i >= cursor.load(std::memory_order_acquire) + H_WINDOW) {
+                reduce();
+                if(i >= bound.load(std::memory_order_relaxed)) return;
+                std::this_thread::yield();
+            }
+
+            int indices[H_SAMPLE];
+            sampleIndices(seed, i, size, indices);
+
+            Transform2d h;
+            counts[i % H_WINDOW] = minimalHomography(matches, indices, h)
+                                 ? transforms::inliersCount(h, matches, threshold) : 0;
+            ready[i % H_WINDOW].store(i, std::memory_order_release);
+
+            reduce();
+        }
+    });
+
+    //a merge skipped because another thread held the flag is finished here
+    reduce();
+
+    Transform2d best{};
+    if(bestIteration >= 0) {
+        int indices[H_SAMPLE];
+        sampleIndices(seed, bestIteration, size, indices);
+        minimalHomography(matches, indices, best);
+    }
+
+    auto inliers = transforms::inliers(best, matches, threshold);
+    return inliers.size() >= H_SAMPLE ? dltHomography(inliers) : best;
+}
+
+//matches must be ordered from the most to the least reliable, e.g. by distance ratio
+template<typename T>
+pi::transforms::Transform2d pi::transforms::prosacHomography(const std::vector<PPairs<T>>& matches,
+                                                             float threshold, int iters, float confidence,
+                                                             std::uint64_t seed) {
+    using namespace t_homography;
+
+    //no model can be estimated from fewer matches than a minimal sample
+    if(matches.size() < H_SAMPLE) return Transform2d{};
+
+    Transform2d best{};
+    auto bestInliersCount = 0;
+    auto size = (int) matches.size();
+
+    //tn is the expected number of the first H_PROSAC_GROWTH uniform samples drawn only from the top n matches
+    auto n = H_SAMPLE;
+    auto tn = (double) H_PROSAC_GROWTH;
+    for(auto i = 0; i < H_SAMPLE; i++) {
+        tn *= (double) (H_SAMPLE - i) / (size - i);
+    }
+    auto tnPrime = 1;
+
+    for(auto t = 1; t <= iters; t++) {
+        if(t == tnPrime && n < size) {
+            auto tnNext = tn * (n + 1) / (n + 1 - H_SAMPLE);
+            tnPrime += (int) std::ceil(tnNext - tn);
+            tn = tnNext;
+            n++;
+        }
+
+        //the newest match of the subset is part of every sample while t <= tnPrime, t only passes tnPrime
+        //once the subset holds all matches and can not grow, from then on sampling is uniform
+        int indices[H_SAMPLE];
+        if(t <= tnPrime) {
+            sampleIndices(seed, t, n - 1, indices, H_SAMPLE - 1);
+            indices[H_SAMPLE - 1] = n - 1;
+        } else {
+            sampleIndices(seed, t, n, indices);
+        }
 
-        auto tmp = transforms::inliers(dltHomography(pairs), matches, threshold);
-        auto tmpSize = tmp.size();
+        Transform2d h;
+        if(!minimalHomography(matches, indices, h)) continue;
 
-        if(tmpSize > bestInliersCount) {
-            bestInliersCount = tmpSize;
-            inliers.swap(tmp);
+        auto inliersCount = transforms::inliersCount(h, matches, threshold);
+        if(inliersCount > bestInliersCount) {
+            bestInliersCount = inliersCount;
+            best = h;
+            iters = std::min(iters, ransacIterations(inliersCount, size, confidence));
         }
     }
 
-    return dltHomography(inliers);
+    auto inliers = transforms::inliers(best, matches, threshold);
+    return inliers.size() >= H_SAMPLE ? dltHomography(inliers) : best;
 }
 
 #endif //COMPUTER_VISION_HOMOGRAPHY_H
@@ -0,0 +1,39 @@
+#ifndef COMPUTER_VISION_INTEGRAL_H
+#define COMPUTER_VISION_INTEGRAL_H
+
+#include <img.h>
+
+namespace pi {
+    class Integral;
+}
+
+class pi::Integral {
+
+protected:
+    int _height;
+    int _width;
+    std::unique_ptr<double[]> _data;
+
+public:
+    explicit Integral(const Img& src);
+
+    Integral(const Integral& integral);
+
+    Integral(Integral&& integral) = default;
+
+    Integral& operator=(const Integral& integral);
+
+    Integral& operator=(Integral&& integral) = default;
+
+    double at(int row, int col) const;
+
+    float box(int row, int col, int rows, int cols) const;
+
+    int width() const;
+
+    int height() const;
+
+    ~Integral() = default;
+};
+
+#endif // COMPUTER_VISION_INTEGRAL_H
@@ -0,0 +1,142 @@
+#ifndef COMPUTER_VISION_IVFPQ_H
+#define COMPUTER_VISION_IVFPQ_H
+
+#include <descriptors.h>
+#include <clustering.h>
+
+#include <string>
+
+namespace pi::descriptors::t_ivfpq {
+    constexpr int IVF_LISTS = 256;
+    constexpr int IVF_PROBES = 8;
+    constexpr int PQ_SUBSPACES = 16;
+    constexpr int PQ_CENTROIDS = 256;
+    constexpr unsigned int IVF_SEED = 0x6976;
+}
+
+namespace pi::descriptors {
+    class IvfPq;
+
+    template<typename U>
+    std::vector<Match> matchIndices(const DescriptorSet<U>& set1, const IvfPq& index, float threshold = .7f,
+                                    int probes = t_ivfpq::IVF_PROBES);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const DescriptorSet<U>& set1, const std::vector<T>& points2, const IvfPq& index, float threshold = .7f,
+          int probes = t_ivfpq::IVF_PROBES);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<T>& points2, const IvfPq& index,
+          float threshold = .7f, int probes = t_ivfpq::IVF_PROBES);
+}
+
+class pi::descriptors::IvfPq {
+
+protected:
+    int _dimension;
+    int _lists;
+    int _subspaces;
+    int _subDimension;
+    int _size;
+    std::vector<float> _coarse;
+    std::vector<float> _codebooks;
+    std::vector<std::vector<int>> _ids;
+    std::vector<std::vector<std::uint8_t>> _codes;
+
+public:
+    IvfPq(int dimension, int lists = t_ivfpq::IVF_LISTS, int subspaces = t_ivfpq::PQ_SUBSPACES);
+
+    IvfPq(const IvfPq& index) = default;
+
+    IvfPq(IvfPq&& index) = default;
+
+    IvfPq& operator=(const IvfPq& index) = default;
+
+    IvfPq& operator=(IvfPq&& index) = default;
+
+    void train(const float* data, int count, int stride, unsigned int seed = t_ivfpq::IVF_SEED);
+
+    template<typename U>
+    void train(const DescriptorSet<U>& sample, unsigned int seed = t_ivfpq::IVF_SEED) {
+        assert(sample.dimension() == _dimension);
+
+        train(sample.data(), sample.size(), sample.stride(), seed);
+    }
+
+    void add(const float* data, int count, int stride);
+
+    template<typename U>
+    void add(const DescriptorSet<U>& set) {
+        assert(set.dimension() == _dimension);
+
+        add(set.data(), set.size(), set.stride());
+    }
+
+    template<typename U>
+    void add(const std::vector<Descriptor<U>>& descriptors) {
+        add(DescriptorSet<U>(descriptors));
+    }
+
+    void search(const float* query, int k, int* indices, float* distances, int probes = t_ivfpq::IVF_PROBES) const;
+
+    void save(const std::string& path) const;
+
+    static IvfPq load(const std::string& path);
+
+    bool trained() const;
+
+    int size() const;
+
+    int dimension() const;
+
+    int lists() const;
+
+    int subspaces() const;
+
+    ~IvfPq() = default;
+
+protected:
+    void _encode(const float* residual, std::uint8_t* code) const;
+};
+
+template<typename U>
+std::vector<pi::descriptors::Match> pi::descriptors::matchIndices(const DescriptorSet<U>& set1, const IvfPq& index,
+                                                                  float threshold, int probes) {
+    assert(set1.dimension() == index.dimension());
+
+    std::vector<Match> matches;
+    int indices[2];
+    float distances[2];
+
+    for(auto i = 0, size1 = set1.size(); i < size1; i++) {
+        index.search(set1.row(i), 2, indices, distances, probes);
+
+        if(indices[1] >= 0 && distances[0] / distances[1] <= threshold) {
+            matches.push_back({i, indices[0], distances[0], distances[0] / distances[1]});
+        }
+    }
+
+    return matches;
+}
+
+//only the train points are needed to resolve matches, the train descriptors live in the index
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const DescriptorSet<U>& set1, const std::vector<T>& points2, const IvfPq& index,
+                       float threshold, int probes) {
+    assert(index.size() == points2.size());
+
+    std::vector<std::pair<T, T>> points;
+    for(const auto &match : matchIndices(set1, index, threshold, probes)) {
+        points.emplace_back(set1.point(match.queryIdx), points2[match.trainIdx]);
+    }
+
+    return points;
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<T>& points2, const IvfPq& index,
+                       float threshold, int probes) {
+    return match<T>(DescriptorSet<U>(descriptors1), points2, index, threshold, probes);
+}
+
+#endif //COMPUTER_VISION_IVFPQ_H
@@ -0,0 +1,104 @@
+#ifndef COMPUTER_VISION_KDFOREST_H
+#define COMPUTER_VISION_KDFOREST_H
+
+#include <descriptors.h>
+
+#include <random>
+
+namespace pi::descriptors::t_kdforest {
+    constexpr int KD_TREES = 4;
+    constexpr int KD_CHECKS = 128;
+    constexpr int KD_LEAF_SIZE = 4;
+    constexpr int KD_RANDOM_DIMS = 5;
+    constexpr int KD_SAMPLES = 128;
+    constexpr unsigned int KD_SEED = 0x6b64;
+}
+
+namespace pi::descriptors {
+    class KdForest;
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+          const KdForest& forest, float threshold = .7f, int checks = t_kdforest::KD_CHECKS);
+}
+
+class pi::descriptors::KdForest {
+
+public:
+    struct Node {
+        int dimension;
+        float value;
+        int left;
+        int right;
+    };
+
+protected:
+    int _dimension;
+    int _size;
+    std::vector<float> _data;
+    std::vector<std::vector<int>> _indices;
+    std::vector<std::vector<Node>> _trees;
+
+public:
+    KdForest(const float* data, int count, int stride, int dimension,
+             int trees = t_kdforest::KD_TREES, unsigned int seed = t_kdforest::KD_SEED);
+
+    template<typename U>
+    explicit KdForest(const DescriptorSet<U>& set, int trees = t_kdforest::KD_TREES,
+                      unsigned int seed = t_kdforest::KD_SEED)
+        : KdForest(set.data(), set.size(), set.stride(), set.dimension(), trees, seed)
+    {
+    }
+
+    template<typename U>
+    explicit KdForest(const std::vector<Descriptor<U>>& descriptors, int trees = t_kdforest::KD_TREES,
+                      unsigned int seed = t_kdforest::KD_SEED)
+        : KdForest(DescriptorSet<U>(descriptors), trees, seed)
+    {
+    }
+
+    KdForest(const KdForest& forest) = default;
+
+    KdForest(KdForest&& forest) = default;
+
+    KdForest& operator=(const KdForest& forest) = default;
+
+    KdForest& operator=(KdForest&& forest) = default;
+
+    void nearest2(const float* query, int* indices, float* distances, int checks = t_kdforest::KD_CHECKS) const;
+
+    int size() const;
+
+    int dimension() const;
+
+    int trees() const;
+
+    ~KdForest() = default;
+
+protected:
+    int _build(std::vector<Node>& nodes, std::vector<int>& indices, int begin, int end, std::mt19937& rand);
+};
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                       const KdForest& forest, float threshold, int checks) {
+    assert(forest.size() == descriptors2.size());
+
+    std::vector<std::pair<T, T>> matches;
+    int indices[2];
+    float distances[2];
+
+    for(const auto &descriptor1 : descriptors1) {
+        assert(descriptor1.size == forest.dimension());
+
+        forest.nearest2(descriptor1.data.get(), indices, distances, checks);
+
+        if(indices[0] >= 0 && distances[0] / distances[1] <= threshold) {
+            matches.emplace_back(descriptor1.point, descriptors2[indices[0]].point);
+        }
+    }
+
+    return matches;
+}
+
+#endif //COMPUTER_VISION_KDFOREST_H
@@ -0,0 +1,121 @@
+#ifndef COMPUTER_VISION_MATCHING_H
+#define COMPUTER_VISION_MATCHING_H
+
+#include <descriptors.h>
+
+namespace pi::descriptors::t_matching {
+    constexpr int M_BLOCK_ROWS = 128;
+    constexpr int M_BLOCK_COLS = 512;
+}
+
+namespace pi::descriptors {
+    void nearest2(const float* query, int queryCount, int queryStride,
+                  const float* train, int trainCount, int trainStride, int dimension,
+                  int* indices, float* distances);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    gemmMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold = .7f);
+
+    void bruteForceNearest2(const float* query, int queryCount, int queryStride,
+                            const float* train, int trainCount, int trainStride, int dimension,
+                            int* indices, float* distances, int threads = 1);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    bruteForceMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold = .7f,
+                    int threads = parallel::concurrency());
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    bruteForceMatch(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                    float threshold = .7f, int threads = parallel::concurrency());
+
+    void mutualNearest2(const float* query, int queryCount, int queryStride,
+                        const float* train, int trainCount, int trainStride, int dimension,
+                        int* queryIndices, float* queryDistances, int* trainIndices, float* trainDistances);
+
+    std::vector<Match> crossCheckMatchIndices(const float* query, int queryCount, int queryStride,
+                                              const float* train, int trainCount, int trainStride,
+                                              int dimension, float threshold = .7f);
+
+    template<typename U>
+    std::vector<Match> crossCheckMatchIndices(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2,
+                                              float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    crossCheckMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    crossCheckMatch(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                    float threshold = .7f);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::gemmMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold) {
+    assert(set1.dimension() == set2.dimension());
+
+    std::vector<std::pair<T, T>> matches;
+    if(set1.size() == 0 || set2.size() == 0) return matches;
+
+    std::vector<int> indices(set1.size());
+    std::vector<float> distances(2 * set1.size());
+
+    nearest2(set1.data(), set1.size(), set1.stride(), set2.data(), set2.size(), set2.stride(), set1.dimension(),
+             indices.data(), distances.data());
+
+    for(auto i = 0; i < set1.size(); i++) {
+        if(distances[2 * i] / distances[2 * i + 1] <= threshold) {
+            matches.emplace_back(set1.point(i), set2.point(indices[i]));
+        }
+    }
+
+    return matches;
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::bruteForceMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold, int threads) {
+    assert(set1.dimension() == set2.dimension());
+
+    std::vector<std::pair<T, T>> matches;
+    if(set1.size() == 0) return matches;
+
+    std::vector<int> indices(set1.size());
+    std::vector<float> distances(2 * set1.size());
+
+    bruteForceNearest2(set1.data(), set1.size(), set1.stride(), set2.data(), set2.size(), set2.stride(),
+                       set1.dimension(), indices.data(), distances.data(), threads);
+
+    for(auto i = 0; i < set1.size(); i++) {
+        if(distances[2 * i] / distances[2 * i + 1] <= threshold) {
+            matches.emplace_back(set1.point(i), set2.point(indices[i]));
+        }
+    }
+
+    return matches;
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::bruteForceMatch(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                                 float threshold, int threads) {
+    return bruteForceMatch<T>(DescriptorSet<U>(descriptors1), DescriptorSet<U>(descriptors2), threshold, threads);
+}
+
+template<typename U>
+std::vector<pi::descriptors::Match> pi::descriptors::crossCheckMatchIndices(const DescriptorSet<U>& set1,
+                                                                            const DescriptorSet<U>& set2, float threshold) {
+    assert(set1.dimension() == set2.dimension());
+
+    return crossCheckMatchIndices(set1.data(), set1.size(), set1.stride(), set2.data(), set2.size(), set2.stride(),
+                                  set1.dimension(), threshold);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::crossCheckMatch(const DescriptorSet<U>& set1, const DescriptorSet<U>& set2, float threshold) {
+    return resolve<T>(crossCheckMatchIndices(set1, set2, threshold), set1, set2);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::crossCheckMatch(const std::vector<Descriptor<U>>& descriptors1, const std::vector<Descriptor<U>>& descriptors2,
+                                 float threshold) {
+    return crossCheckMatch<T>(DescriptorSet<U>(descriptors1), DescriptorSet<U>(descriptors2), threshold);
+}
+
+#endif //COMPUTER_VISION_MATCHING_H
@@ -0,0 +1,172 @@
+#ifndef COMPUTER_VISION_PARALLEL_H
+#define COMPUTER_VISION_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pi::parallel {
+    constexpr int P_GRAIN = 16;
+
+    class Pool;
+
+    int concurrency();
+
+    template<typename F>
+    void run(int threads, F&& function);
+
+    template<typename F>
+    void forEach(int count, int threads, F&& function, int grain = P_GRAIN);
+}
+
+class pi::parallel::Pool {
+
+protected:
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::function<void()>> _tasks;
+    bool _stopping;
+    std::vector<std::thread> _workers;
+
+public:
+    explicit Pool(int threads)
+        : _stopping(false)
+    {
+        _workers.reserve(threads);
+        for(auto t = 0; t < threads; t++) {
+            _workers.emplace_back([this]() { _work(); });
+        }
+    }
+
+    Pool(const Pool& pool) = delete;
+
+    Pool& operator=(const Pool& pool) = delete;
+
+    //shared by the whole lib, the calling thread of run is the remaining hardware thread
+    static Pool& instance() {
+        static Pool pool(concurrency() - 1);
+        return pool;
+    }
+
+    static bool inside() {
+        return _inside();
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back(std::move(task));
+        }
+        _condition.notify_one();
+    }
+
+    int size() const {
+        return (int) _workers.size();
+    }
+
+    ~Pool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _condition.notify_all();
+
+        for(auto &thread : _workers) {
+            thread.join();
+        }
+    }
+
+protected:
+    static bool& _inside() {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    void _work() {
+        _inside() = true;
+
+        while(true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+
+                if(_tasks.empty()) return;
+
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+};
+
+inline int pi::parallel::concurrency() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+//calls function(thread) once for every thread in [0; threads) on the calling thread and the shared pool,
+//the calls may also run one after another, so they must never wait for each other
+template<typename F>
+void pi::parallel::run(int threads, F&& function) {
+    assert(threads > 0);
+
+    //inside a pool task the siblings could wait for workers that are all busy, so nested calls run inline
+    if(threads == 1 || Pool::inside() || Pool::instance().size() == 0) {
+        for(auto t = 0; t < threads; t++) {
+            function(t);
+        }
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    auto remaining = threads - 1;
+
+    for(auto t = 1; t < threads; t++) {
+        Pool::instance().submit([&, t]() {
+            function(t);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--remaining == 0) condition.notify_one();
+        });
+    }
+
+    function(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() { return remaining == 0; });
+}
+
+//calls function(index) for every index in [0; count), workers take blocks of grain indices
+template<typename F>
+void pi::parallel::forEach(int count, int threads, F&& function, int grain) {
+    assert(threads > 0 && grain > 0);
+
+    threads = std::min(threads, (count + grain - 1) / grain);
+
+    if(threads <= 1) {
+        for(auto i = 0; i < count; i++) {
+            function(i);
+        }
+        return;
+    }
+
+    std::atomic<int> next{0};
+    run(threads, [&](int) {
+        for(auto begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain)) {
+            for(auto i = begin, end = std::min(begin + grain, count); i < end; i++) {
+                function(i);
+            }
+        }
+    });
+}
+
+#endif //COMPUTER_VISION_PARALLEL_H
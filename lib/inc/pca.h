@@ -0,0 +1,119 @@
+#ifndef COMPUTER_VISION_PCA_H
+#define COMPUTER_VISION_PCA_H
+
+#include <descriptors.h>
+
+#include <string>
+
+namespace pi::descriptors::t_pca {
+    constexpr int PCA_DIMENSION = 32;
+}
+
+namespace pi::descriptors {
+    class Pca;
+
+    Pca pca(const float* data, int count, int stride, int dimension, int components = t_pca::PCA_DIMENSION);
+
+    template<typename T>
+    Pca pca(const DescriptorSet<T>& sample, int components = t_pca::PCA_DIMENSION);
+
+    template<typename T>
+    Pca pca(const std::vector<Descriptor<T>>& sample, int components = t_pca::PCA_DIMENSION);
+}
+
+class pi::descriptors::Pca {
+
+protected:
+    int _dimension;
+    int _components;
+    std::vector<float> _mean;
+    std::vector<float> _basis;
+    std::vector<float> _offset;
+
+public:
+    Pca(int dimension, int components, std::vector<float> mean, std::vector<float> basis);
+
+    Pca(const Pca& pca) = default;
+
+    Pca(Pca&& pca) = default;
+
+    Pca& operator=(const Pca& pca) = default;
+
+    Pca& operator=(Pca&& pca) = default;
+
+    void project(const float* src, int count, int srcStride, float* dst, int dstStride) const;
+
+    template<typename T>
+    DescriptorSet<T> project(const DescriptorSet<T>& set) const;
+
+    template<typename T>
+    std::vector<Descriptor<T>> project(const std::vector<Descriptor<T>>& descriptors) const;
+
+    void save(const std::string& path) const;
+
+    static Pca load(const std::string& path);
+
+    const std::vector<float>& mean() const;
+
+    const std::vector<float>& basis() const;
+
+    int dimension() const;
+
+    int components() const;
+
+    ~Pca() = default;
+};
+
+template<typename T>
+pi::descriptors::Pca pi::descriptors::pca(const DescriptorSet<T>& sample, int components) {
+    return pca(sample.data(), sample.size(), sample.stride(), sample.dimension(), components);
+}
+
+template<typename T>
+pi::descriptors::Pca pi::descriptors::pca(const std::vector<Descriptor<T>>& sample, int components) {
+    return pca(DescriptorSet<T>(sample), components);
+}
+
+template<typename T>
+pi::descriptors::DescriptorSet<T> pi::descriptors::Pca::project(const DescriptorSet<T>& set) const {
+    assert(set.dimension() == _dimension);
+
+    DescriptorSet<T> projected(_components, set.size());
+    for(const auto &point : set.points()) {
+        projected.push(point);
+    }
+
+    if(set.size() > 0) {
+        project(set.data(), set.size(), set.stride(), projected.data(), projected.stride());
+    }
+
+    return projected;
+}
+
+template<typename T>
+std::vector<pi::descriptors::Descriptor<T>> pi::descriptors::Pca::project(const std::vector<Descriptor<T>>& descriptors) const {
+    std::vector<float> src(descriptors.size() * _dimension);
+    std::vector<float> dst(descriptors.size() * _components);
+
+    for(auto i = 0; i < descriptors.size(); i++) {
+        assert(descriptors[i].size == _dimension);
+
+        std::copy(descriptors[i].data.get(), descriptors[i].data.get() + _dimension, src.data() + i * _dimension);
+    }
+
+    if(!descriptors.empty()) {
+        project(src.data(), descriptors.size(), _dimension, dst.data(), _components);
+    }
+
+    std::vector<Descriptor<T>> projected;
+    projected.reserve(descriptors.size());
+
+    for(auto i = 0; i < descriptors.size(); i++) {
+        projected.emplace_back(descriptors[i].point, _components);
+        std::copy(dst.data() + i * _components, dst.data() + (i + 1) * _components, projected.back().data.get());
+    }
+
+    return projected;
+}
+
+#endif //COMPUTER_VISION_PCA_H
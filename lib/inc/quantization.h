@@ -0,0 +1,163 @@
+#ifndef COMPUTER_VISION_QUANTIZATION_H
+#define COMPUTER_VISION_QUANTIZATION_H
+
+#include <descriptors.h>
+
+#include <climits>
+#include <cstdint>
+
+namespace pi::descriptors {
+    template<typename T>
+    class QDescriptorSet;
+
+    using QRiDescriptorSet = QDescriptorSet<detectors::RPoint>;
+    using QSiDescriptorSet = QDescriptorSet<detectors::SPoint>;
+
+    constexpr float Q_SCALE = 512.f;
+
+    template<typename T>
+    QDescriptorSet<T> quantize(const DescriptorSet<T>& set, float scale = Q_SCALE);
+
+    template<typename T>
+    QDescriptorSet<T> quantize(const std::vector<Descriptor<T>>& descriptors, float scale = Q_SCALE);
+
+    void quantize(std::uint8_t* quantized, const float* descriptor, int size, float scale = Q_SCALE);
+
+    int distance(const std::uint8_t* descriptor1, const std::uint8_t* descriptor2, int size);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const QDescriptorSet<U>& set1, const QDescriptorSet<U>& set2, float threshold = .7f);
+}
+
+template<typename T>
+class pi::descriptors::QDescriptorSet {
+
+public:
+    constexpr static int ALIGNMENT = 32;
+
+protected:
+    int _dimension;
+    int _stride;
+    std::vector<T> _points;
+    std::vector<std::uint8_t> _data;
+
+public:
+    explicit QDescriptorSet(int dimension, int capacity = 0)
+        : _dimension(dimension)
+        , _stride((dimension + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT)
+    {
+        assert(dimension > 0);
+
+        _points.reserve(capacity);
+        _data.reserve(capacity * _stride);
+    }
+
+    QDescriptorSet(const QDescriptorSet& set) = default;
+
+    QDescriptorSet(QDescriptorSet&& set) = default;
+
+    QDescriptorSet& operator=(const QDescriptorSet& set) = default;
+
+    QDescriptorSet& operator=(QDescriptorSet&& set) = default;
+
+    std::uint8_t* push(T point) {
+        _points.push_back(std::move(point));
+        _data.resize(_data.size() + _stride, 0);
+
+        return row(size() - 1);
+    }
+
+    const std::uint8_t* data() const {
+        return _data.data();
+    }
+
+    const std::uint8_t* row(int index) const {
+        assert(0 <= index && index < size());
+
+        return _data.data() + index * _stride;
+    }
+
+    std::uint8_t* row(int index) {
+        assert(0 <= index && index < size());
+
+        return _data.data() + index * _stride;
+    }
+
+    const T& point(int index) const {
+        return _points[index];
+    }
+
+    const std::vector<T>& points() const {
+        return _points;
+    }
+
+    int size() const {
+        return _points.size();
+    }
+
+    int dimension() const {
+        return _dimension;
+    }
+
+    int stride() const {
+        return _stride;
+    }
+
+    ~QDescriptorSet() = default;
+};
+
+template<typename T>
+pi::descriptors::QDescriptorSet<T> pi::descriptors::quantize(const DescriptorSet<T>& set, float scale) {
+    QDescriptorSet<T> quantized(set.dimension(), set.size());
+
+    for(auto i = 0; i < set.size(); i++) {
+        quantize(quantized.push(set.point(i)), set.row(i), set.dimension(), scale);
+    }
+
+    return quantized;
+}
+
+template<typename T>
+pi::descriptors::QDescriptorSet<T> pi::descriptors::quantize(const std::vector<Descriptor<T>>& descriptors, float scale) {
+    QDescriptorSet<T> quantized(descriptors.empty() ? 1 : descriptors.front().size, descriptors.size());
+
+    for(const auto &descriptor : descriptors) {
+        assert(descriptor.size == quantized.dimension());
+
+        quantize(quantized.push(descriptor.point), descriptor.data.get(), descriptor.size, scale);
+    }
+
+    return quantized;
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const QDescriptorSet<U>& set1, const QDescriptorSet<U>& set2, float threshold) {
+    assert(set1.dimension() == set2.dimension());
+
+    std::vector<std::pair<T, T>> matches;
+    auto dimension = set1.dimension();
+
+    for(auto i = 0, size1 = set1.size(); i < size1; i++) {
+        auto minDistance1 = INT_MAX, minDistance2 = INT_MAX;
+        auto index = 0;
+
+        for(auto j = 0, size2 = set2.size(); j < size2; j++) {
+            auto distance = descriptors::distance(set1.row(i), set2.row(j), dimension);
+            if(distance < minDistance1) {
+                minDistance2 = minDistance1;
+                minDistance1 = distance;
+                index = j;
+            } else if(distance < minDistance2) {
+                minDistance2 = distance;
+            }
+        }
+
+        if((float) minDistance1 / minDistance2 <= threshold) {
+            matches.emplace_back(set1.point(i), set2.point(index));
+        }
+    }
+
+    return matches;
+}
+
+#endif //COMPUTER_VISION_QUANTIZATION_H
@@ -0,0 +1,258 @@
+#ifndef COMPUTER_VISION_STORAGE_H
+#define COMPUTER_VISION_STORAGE_H
+
+#include <quantization.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace pi::descriptors::t_storage {
+    constexpr char F_MAGIC[4] = {'P', 'I', 'F', 'T'};
+    constexpr std::uint32_t F_VERSION = 1;
+    constexpr int F_ALIGNMENT = 64;
+
+    enum PointTypes {
+        POINT = 0,
+        R_POINT = 1,
+        S_POINT = 2
+    };
+
+    enum ValueTypes {
+        FLOAT32 = 0,
+        UINT8 = 1
+    };
+}
+
+namespace pi::descriptors {
+    struct FeatureHeader;
+
+    class MappedFile;
+
+    template<typename T, typename V = float>
+    class MappedDescriptorSet;
+
+    void validate(const std::uint8_t* data, std::size_t size, std::uint32_t pointType, std::uint32_t pointSize,
+                  std::uint32_t valueType, std::uint32_t valueSize);
+
+    template<typename T, typename V>
+    void save(const std::string& path, const T* points, const V* data, int count, int dimension, int stride);
+
+    template<typename T>
+    void save(const std::string& path, const DescriptorSet<T>& set);
+
+    template<typename T>
+    void save(const std::string& path, const QDescriptorSet<T>& set);
+
+    template<typename T, typename S1, typename S2>
+    std::vector<std::pair<T, T>> matchRows(const S1& set1, const S2& set2, float threshold = .7f);
+
+    template<typename T, typename U, typename V> MatchResolvedType<detectors::Point, T>
+    match(const MappedDescriptorSet<U, V>& set1, const MappedDescriptorSet<U, V>& set2, float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const DescriptorSet<U>& set1, const MappedDescriptorSet<U, float>& set2, float threshold = .7f);
+
+    template<typename T, typename U> MatchResolvedType<detectors::Point, T>
+    match(const QDescriptorSet<U>& set1, const MappedDescriptorSet<U, std::uint8_t>& set2, float threshold = .7f);
+}
+
+struct pi::descriptors::FeatureHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t pointType;
+    std::uint32_t pointSize;
+    std::uint32_t valueType;
+    std::uint32_t dimension;
+    std::uint32_t stride;
+    std::uint32_t reserved;
+    std::uint64_t count;
+    std::uint64_t pointsOffset;
+    std::uint64_t dataOffset;
+};
+
+class pi::descriptors::MappedFile {
+
+protected:
+    void* _data;
+    std::size_t _size;
+
+public:
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile& file) = delete;
+
+    MappedFile(MappedFile&& file) noexcept;
+
+    MappedFile& operator=(const MappedFile& file) = delete;
+
+    MappedFile& operator=(MappedFile&& file) noexcept;
+
+    const std::uint8_t* data() const;
+
+    std::size_t size() const;
+
+    ~MappedFile();
+};
+
+template<typename T, typename V>
+class pi::descriptors::MappedDescriptorSet {
+
+protected:
+    MappedFile _file;
+    const FeatureHeader* _header;
+    const T* _points;
+    const V* _data;
+
+public:
+    explicit MappedDescriptorSet(const std::string& path)
+        : _file(path)
+        , _header(reinterpret_cast<const FeatureHeader*>(_file.data()))
+    {
+        validate(_file.data(), _file.size(), pointType(), sizeof(T), valueType(), sizeof(V));
+
+        _points = reinterpret_cast<const T*>(_file.data() + _header->pointsOffset);
+        _data = reinterpret_cast<const V*>(_file.data() + _header->dataOffset);
+    }
+
+    MappedDescriptorSet(const MappedDescriptorSet& set) = delete;
+
+    MappedDescriptorSet(MappedDescriptorSet&& set) = default;
+
+    MappedDescriptorSet& operator=(const MappedDescriptorSet& set) = delete;
+
+    MappedDescriptorSet& operator=(MappedDescriptorSet&& set) = default;
+
+    const V* data() const {
+        return _data;
+    }
+
+    const V* row(int index) const {
+        assert(0 <= index && index < size());
+
+        return _data + (std::size_t) index * _header->stride;
+    }
+
+    const T& point(int index) const {
+        assert(0 <= index && index < size());
+
+        return _points[index];
+    }
+
+    const T* points() const {
+        return _points;
+    }
+
+    int size() const {
+        return _header->count;
+    }
+
+    int dimension() const {
+        return _header->dimension;
+    }
+
+    int stride() const {
+        return _header->stride;
+    }
+
+    ~MappedDescriptorSet() = default;
+
+    static constexpr std::uint32_t pointType() {
+        if constexpr (std::is_same<T, detectors::SPoint>::value) return t_storage::S_POINT;
+        else if constexpr (std::is_same<T, detectors::RPoint>::value) return t_storage::R_POINT;
+        else return t_storage::POINT;
+    }
+
+    static constexpr std::uint32_t valueType() {
+        return std::is_same<V, std::uint8_t>::value ? t_storage::UINT8 : t_storage::FLOAT32;
+    }
+};
+
+template<typename T, typename V>
+void pi::descriptors::save(const std::string& path, const T* points, const V* data, int count, int dimension, int stride) {
+    static_assert(std::is_trivially_copyable<T>::value);
+
+    auto align = [](std::uint64_t offset) {
+        return (offset + t_storage::F_ALIGNMENT - 1) / t_storage::F_ALIGNMENT * t_storage::F_ALIGNMENT;
+    };
+
+    FeatureHeader header{};
+    std::copy(std::begin(t_storage::F_MAGIC), std::end(t_storage::F_MAGIC), header.magic);
+    header.version = t_storage::F_VERSION;
+    header.pointType = MappedDescriptorSet<T, V>::pointType();
+    header.pointSize = sizeof(T);
+    header.valueType = MappedDescriptorSet<T, V>::valueType();
+    header.dimension = dimension;
+    header.stride = stride;
+    header.count = count;
+    header.pointsOffset = align(sizeof(FeatureHeader));
+    header.dataOffset = align(header.pointsOffset + header.count * sizeof(T));
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open()) throw std::runtime_error("storage: cannot write " + path);
+
+    const char zeros[t_storage::F_ALIGNMENT] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(zeros, header.pointsOffset - sizeof(header));
+    file.write(reinterpret_cast<const char*>(points), header.count * sizeof(T));
+    file.write(zeros, header.dataOffset - header.pointsOffset - header.count * sizeof(T));
+    file.write(reinterpret_cast<const char*>(data), header.count * stride * sizeof(V));
+    if(!file) throw std::runtime_error("storage: cannot write " + path);
+}
+
+template<typename T>
+void pi::descriptors::save(const std::string& path, const DescriptorSet<T>& set) {
+    save(path, set.points().data(), set.data(), set.size(), set.dimension(), set.stride());
+}
+
+template<typename T>
+void pi::descriptors::save(const std::string& path, const QDescriptorSet<T>& set) {
+    save(path, set.points().data(), set.data(), set.size(), set.dimension(), set.stride());
+}
+
+template<typename T, typename S1, typename S2>
+std::vector<std::pair<T, T>> pi::descriptors::matchRows(const S1& set1, const S2& set2, float threshold) {
+    assert(set1.dimension() == set2.dimension());
+
+    std::vector<std::pair<T, T>> matches;
+    auto dimension = set1.dimension();
+
+    for(auto i = 0, size1 = set1.size(); i < size1; i++) {
+        auto minDistance1 = FLT_MAX, minDistance2 = FLT_MAX;
+        auto index = 0;
+
+        for(auto j = 0, size2 = set2.size(); j < size2; j++) {
+            auto distance = (float) descriptors::distance(set1.row(i), set2.row(j), dimension);
+            if(distance < minDistance1) {
+                minDistance2 = minDistance1;
+                minDistance1 = distance;
+                index = j;
+            } else if(distance < minDistance2) {
+                minDistance2 = distance;
+            }
+        }
+
+        if(minDistance1 / minDistance2 <= threshold) {
+            matches.emplace_back(set1.point(i), set2.point(index));
+        }
+    }
+
+    return matches;
+}
+
+template<typename T, typename U, typename V> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const MappedDescriptorSet<U, V>& set1, const MappedDescriptorSet<U, V>& set2, float threshold) {
+    return matchRows<T>(set1, set2, threshold);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const DescriptorSet<U>& set1, const MappedDescriptorSet<U, float>& set2, float threshold) {
+    return matchRows<T>(set1, set2, threshold);
+}
+
+template<typename T, typename U> pi::descriptors::MatchResolvedType<pi::detectors::Point, T>
+pi::descriptors::match(const QDescriptorSet<U>& set1, const MappedDescriptorSet<U, std::uint8_t>& set2, float threshold) {
+    return matchRows<T>(set1, set2, threshold);
+}
+
+#endif //COMPUTER_VISION_STORAGE_H
@@ -21,6 +21,9 @@ namespace pi::transforms {
     template<typename T>
     Transform2d dltAffine(const std::vector<PPairs<T>>& pairs);
 
+    template<typename T>
+    bool isInlier(const Transform2d& h, const PPairs<T>& pair, float threshold);
+
     template<typename T>
     std::vector<PPairs<T>> inliers(const Transform2d& h, const std::vector<PPairs<T>>& matches,
                                    float threshold);
@@ -137,25 +140,31 @@ pi::transforms::Transform2d pi::transforms::dltAffine(const std::vector<PPairs<T
     return h;
 }
 
+//maps the first point of the pair by h and compares it with the second one
 template<typename T>
-std::vector<pi::transforms::PPairs<T>> pi::transforms::inliers(const Transform2d& h,
-                                                               const std::vector<PPairs<T>>& matches,
-                                                               float threshold) {
-    std::vector<PPairs<T>> inliers;
-
+bool pi::transforms::isInlier(const Transform2d& h, const PPairs<T>& pair, float threshold) {
     auto mul = [](const Transform1d& h, int x, int y, int d) {
         return h[0] * x + h[1] * y + h[2] * d;
     };
 
-    for(const auto &pair : matches) {
-        auto &fPoint = pair.first;
-        auto &sPoint = pair.second;
+    auto &fPoint = pair.first;
+    auto &sPoint = pair.second;
 
-        auto div = mul(h[2], fPoint.col, fPoint.row, 1);
-        auto sX = mul(h[0], fPoint.col, fPoint.row, 1) / div;
-        auto sY = mul(h[1], fPoint.col, fPoint.row, 1) / div;
+    auto div = mul(h[2], fPoint.col, fPoint.row, 1);
+    auto sX = mul(h[0], fPoint.col, fPoint.row, 1) / div;
+    auto sY = mul(h[1], fPoint.col, fPoint.row, 1) / div;
 
-        if(std::hypot(sX - sPoint.col, sY - sPoint.row) < threshold) {
+    return std::hypot(sX - sPoint.col, sY - sPoint.row) < threshold;
+}
+
+template<typename T>
+std::vector<pi::transforms::PPairs<T>> pi::transforms::inliers(const Transform2d& h,
+                                                               const std::vector<PPairs<T>>& matches,
+                                                               float threshold) {
+    std::vector<PPairs<T>> inliers;
+
+    for(const auto &pair : matches) {
+        if(isInlier(h, pair, threshold)) {
             inliers.push_back(pair);
         }
     }
@@ -0,0 +1,112 @@
+#ifndef COMPUTER_VISION_VOCABULARY_H
+#define COMPUTER_VISION_VOCABULARY_H
+
+#include <descriptors.h>
+#include <clustering.h>
+
+namespace pi::descriptors::t_vocabulary {
+    constexpr int VT_BRANCHING = 10;
+    constexpr int VT_DEPTH = 4;
+    constexpr int VT_SHORTLIST = 5;
+    constexpr unsigned int VT_SEED = 0x7674;
+}
+
+namespace pi::descriptors {
+    class VocabularyTree;
+}
+
+class pi::descriptors::VocabularyTree {
+
+public:
+    struct Node {
+        int children;
+        int count;
+        int word;
+    };
+
+    struct Norm {
+        double squares;
+        double logs;
+        double squaredLogs;
+    };
+
+protected:
+    int _dimension;
+    int _branching;
+    int _words;
+    std::vector<Node> _nodes;
+    std::vector<float> _centroids;
+    std::vector<std::vector<std::pair<int, int>>> _inverted;
+    std::vector<std::vector<std::pair<int, int>>> _images;
+    std::vector<float> _totals;
+    std::vector<Norm> _norms;
+
+public:
+    VocabularyTree(const float* data, int count, int stride, int dimension,
+                   int branching = t_vocabulary::VT_BRANCHING, int depth = t_vocabulary::VT_DEPTH,
+                   unsigned int seed = t_vocabulary::VT_SEED);
+
+    template<typename U>
+    explicit VocabularyTree(const DescriptorSet<U>& set, int branching = t_vocabulary::VT_BRANCHING,
+                            int depth = t_vocabulary::VT_DEPTH, unsigned int seed = t_vocabulary::VT_SEED)
+        : VocabularyTree(set.data(), set.size(), set.stride(), set.dimension(), branching, depth, seed)
+    {
+    }
+
+    VocabularyTree(const VocabularyTree& tree) = default;
+
+    VocabularyTree(VocabularyTree&& tree) = default;
+
+    VocabularyTree& operator=(const VocabularyTree& tree) = default;
+
+    VocabularyTree& operator=(VocabularyTree&& tree) = default;
+
+    int word(const float* descriptor) const;
+
+    int add(const float* data, int count, int stride);
+
+    template<typename U>
+    int add(const DescriptorSet<U>& set) {
+        assert(set.dimension() == _dimension);
+
+        return add(set.data(), set.size(), set.stride());
+    }
+
+    template<typename U>
+    int add(const std::vector<Descriptor<U>>& descriptors) {
+        return add(DescriptorSet<U>(descriptors));
+    }
+
+    std::vector<std::pair<int, float>> query(const float* data, int count, int stride,
+                                             int shortlist = t_vocabulary::VT_SHORTLIST) const;
+
+    template<typename U>
+    std::vector<std::pair<int, float>> query(const DescriptorSet<U>& set, int shortlist = t_vocabulary::VT_SHORTLIST) const {
+        assert(set.dimension() == _dimension);
+
+        return query(set.data(), set.size(), set.stride(), shortlist);
+    }
+
+    template<typename U>
+    std::vector<std::pair<int, float>> query(const std::vector<Descriptor<U>>& descriptors,
+                                             int shortlist = t_vocabulary::VT_SHORTLIST) const {
+        return query(DescriptorSet<U>(descriptors), shortlist);
+    }
+
+    int words() const;
+
+    int images() const;
+
+    ~VocabularyTree() = default;
+
+protected:
+    void _build(int id, const float* data, int stride, const std::vector<int>& indices, int depth, std::mt19937& rand);
+
+    std::vector<std::pair<int, int>> _histogram(const float* data, int count, int stride) const;
+
+    float _idf(int word) const;
+
+    float _norm(int image) const;
+};
+
+#endif //COMPUTER_VISION_VOCABULARY_H
@@ -0,0 +1,115 @@
+#include <brief.h>
+#include <cpu.h>
+
+#include <random>
+
+using namespace pi;
+
+namespace {
+    constexpr unsigned int BR_SEED = 0x5eed;
+
+    struct _Pair {
+        float r1, c1;
+        float r2, c2;
+    };
+
+    //isotropic gaussian test locations (G II in the BRIEF paper), the same for every call
+    std::vector<_Pair> _pattern(int bits, int patchSize) {
+        std::mt19937 rand{BR_SEED};
+        std::normal_distribution<float> distribution(0, patchSize / 5.f);
+        auto radius = (float) (patchSize / 2);
+
+        auto sample = [&]() {
+            return std::clamp(distribution(rand), -radius, radius);
+        };
+
+        std::vector<_Pair> pattern(bits);
+        for(auto &pair : pattern) {
+            pair = {sample(), sample(), sample(), sample()};
+        }
+
+        return pattern;
+    }
+
+    template<typename T>
+    descriptors::BinaryDescriptorSet<T> _brief(const std::vector<T>& points, const Img& src,
+                                               int patchSize, float sigma, borders::BorderTypes border) {
+        assert(src.channels() == 1);
+
+        descriptors::BinaryDescriptorSet<T> set(descriptors::t_brief::BR_BITS, points.size());
+        auto pattern = _pattern(set.bits(), patchSize);
+
+        auto smoothed = filters::gaussian(src, sigma, border);
+        auto fBorder = borders::get(border);
+        //rotated test locations stay within the circle around the patch
+        auto radius = (int) std::ceil(patchSize / 2 * M_SQRT2) + 1;
+
+        for(const auto &point : points) {
+            auto fCos = 1.f, fSin = 0.f;
+            if constexpr (std::is_base_of<detectors::RPoint, T>::value) {
+                fCos = std::cos(point.angle);
+                fSin = std::sin(point.angle);
+            }
+
+            auto isInside = point.row - radius >= 0 && point.row + radius < smoothed.height()
+                    && point.col - radius >= 0 && point.col + radius < smoothed.width();
+
+            auto intensity = [&](float r, float c) {
+                //steer the test location by the keypoint orientation
+                auto row = point.row + (int) std::lround(r * fCos + c * fSin);
+                auto col = point.col + (int) std::lround(c * fCos - r * fSin);
+
+                return isInside ? *smoothed.at(row, col) : fBorder(row, col, smoothed);
+            };
+
+            auto* descriptor = set.push(point);
+            for(auto bit = 0; bit < set.bits(); bit++) {
+                const auto &pair = pattern[bit];
+
+                if(intensity(pair.r1, pair.c1) < intensity(pair.r2, pair.c2)) {
+                    descriptor[bit / 64] |= std::uint64_t{1} << (bit % 64);
+                }
+            }
+        }
+
+        return set;
+    }
+
+    //always inlined, so the builtin is expanded with the instruction set of the caller
+    inline __attribute__((always_inline))
+    int _hamming(const std::uint64_t* descriptor1, const std::uint64_t* descriptor2, int words) {
+        auto distance = 0;
+        for(auto i = 0; i < words; i++) {
+            distance += __builtin_popcountll(descriptor1[i] ^ descriptor2[i]);
+        }
+
+        return distance;
+    }
+
+#ifdef PI_X86_DISPATCH
+    __attribute__((target("popcnt")))
+    int _hammingPopcnt(const std::uint64_t* descriptor1, const std::uint64_t* descriptor2, int words) {
+        return _hamming(descriptor1, descriptor2, words);
+    }
+#endif
+}
+
+descriptors::BrDescriptorSet descriptors::briefDescriptorSet(const std::vector<detectors::Point>& points,
+                                                             const Img& src, int patchSize, float sigma,
+                                                             borders::BorderTypes border) {
+    return _brief(points, src, patchSize, sigma, border);
+}
+
+descriptors::RBrDescriptorSet descriptors::briefDescriptorSet(const std::vector<detectors::RPoint>& points,
+                                                              const Img& src, int patchSize, float sigma,
+                                                              borders::BorderTypes border) {
+    return _brief(points, src, patchSize, sigma, border);
+}
+
+int descriptors::hamming(const std::uint64_t* descriptor1, const std::uint64_t* descriptor2, int words) {
+#ifdef PI_X86_DISPATCH
+    if(cpu::popcnt()) return _hammingPopcnt(descriptor1, descriptor2, words);
+#endif
+
+    return _hamming(descriptor1, descriptor2, words);
+}
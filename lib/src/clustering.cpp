@@ -0,0 +1,119 @@
+#include <clustering.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <numeric>
+
+using namespace pi;
+
+std::vector<float> clustering::kmeans(const float* data, int stride, int dimension, const std::vector<int>& indices,
+                                      int k, std::mt19937& rand, std::vector<int>& labels, int iters) {
+    assert(k > 0 && !indices.empty());
+
+    auto count = (int) indices.size();
+    k = std::min(k, count);
+
+    auto row = [&](int i) {
+        return data + (std::size_t) indices[i] * stride;
+    };
+
+    //k-means++ seeding
+    std::vector<float> centroids(k * dimension);
+    std::vector<float> distances(count, FLT_MAX);
+
+    auto first = std::uniform_int_distribution<int>(0, count - 1)(rand);
+    std::copy(row(first), row(first) + dimension, centroids.data());
+
+    for(auto c = 1; c < k; c++) {
+        const auto* centroid = centroids.data() + (c - 1) * dimension;
+        for(auto i = 0; i < count; i++) {
+            distances[i] = std::min(distances[i], squaredDistance(row(i), centroid, dimension));
+        }
+
+        auto sum = std::accumulate(std::begin(distances), std::end(distances), .0);
+        auto chosen = 0;
+
+        if(sum > 0) {
+            auto target = std::uniform_real_distribution<double>(0, sum)(rand);
+            for(auto acc = .0; chosen < count - 1; chosen++) {
+                acc += distances[chosen];
+                if(acc >= target) break;
+            }
+        } else {
+            chosen = std::uniform_int_distribution<int>(0, count - 1)(rand);
+        }
+
+        std::copy(row(chosen), row(chosen) + dimension, centroids.data() + c * dimension);
+    }
+
+    //lloyd iterations
+    labels.assign(count, 0);
+    std::vector<double> sums(k * dimension);
+    std::vector<int> sizes(k);
+
+    for(auto iter = 0; iter < iters; iter++) {
+        auto changed = false;
+        for(auto i = 0; i < count; i++) {
+            auto label = nearest(centroids.data(), k, dimension, row(i));
+            changed |= label != labels[i];
+            labels[i] = label;
+        }
+
+        if(iter > 0 && !changed) break;
+
+        std::fill(std::begin(sums), std::end(sums), .0);
+        std::fill(std::begin(sizes), std::end(sizes), 0);
+
+        for(auto i = 0; i < count; i++) {
+            auto* sum = sums.data() + labels[i] * dimension;
+            for(auto j = 0; j < dimension; j++) {
+                sum[j] += row(i)[j];
+            }
+            sizes[labels[i]]++;
+        }
+
+        for(auto c = 0; c < k; c++) {
+            if(sizes[c] == 0) continue;
+
+            for(auto j = 0; j < dimension; j++) {
+                centroids[c * dimension + j] = sums[c * dimension + j] / sizes[c];
+            }
+        }
+    }
+
+    return centroids;
+}
+
+std::vector<float> clustering::kmeans(const float* data, int count, int stride, int dimension,
+                                      int k, std::mt19937& rand, std::vector<int>& labels, int iters) {
+    std::vector<int> indices(count);
+    std::iota(std::begin(indices), std::end(indices), 0);
+
+    return kmeans(data, stride, dimension, indices, k, rand, labels, iters);
+}
+
+int clustering::nearest(const float* centroids, int k, int dimension, const float* value) {
+    auto best = 0;
+    auto bestDistance = FLT_MAX;
+
+    for(auto c = 0; c < k; c++) {
+        auto distance = squaredDistance(centroids + c * dimension, value, dimension);
+        if(distance < bestDistance) {
+            bestDistance = distance;
+            best = c;
+        }
+    }
+
+    return best;
+}
+
+float clustering::squaredDistance(const float* value1, const float* value2, int dimension) {
+    auto distance = .0f;
+    for(auto i = 0; i < dimension; i++) {
+        auto difference = value1[i] - value2[i];
+        distance += difference * difference;
+    }
+
+    return distance;
+}
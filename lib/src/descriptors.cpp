@@ -1,5 +1,7 @@
 #include <descriptors.h>
 
+#include <array>
+
 using namespace pi;
 
 namespace {
@@ -7,11 +9,37 @@ namespace {
     int _parabolic3bfit(const descriptors::Descriptor<T>& descriptor, int peak) {
         assert(peak >= 0 && peak < descriptor.size);
 
-        auto ym1 = descriptor.data[(peak - 1) % descriptor.size];
+        auto ym1 = descriptor.data[(peak - 1 + descriptor.size) % descriptor.size];
         auto y0 = descriptor.data[peak];
         auto yp1 = descriptor.data[(peak + 1) % descriptor.size];
-        auto p = (ym1 - yp1) / (2 * (ym1 - 2 * y0 + yp1)); // [-1/2;1/2]
-        return ((peak + p < 0) ? descriptor.size : peak) + p;
+        auto denominator = 2 * (ym1 - 2 * y0 + yp1);
+
+        auto p = denominator != 0 ? (ym1 - yp1) / denominator : .0f; // [-1/2;1/2] at a local maximum
+
+        //a peak that is not a local maximum can fit outside the histogram, wrap it back to [0; size)
+        auto position = peak + p;
+        return position - descriptor.size * std::floor(position / descriptor.size);
+    }
+
+    constexpr int SUM_LANES = 8;
+
+    //independent partial sums let the compiler keep them in one vector register
+    float _sumSq(const float* first, int size) {
+        float partial[SUM_LANES] = {};
+        auto i = 0;
+
+        for(; i + SUM_LANES <= size; i += SUM_LANES) {
+            for(auto lane = 0; lane < SUM_LANES; lane++) {
+                partial[lane] += first[i + lane] * first[i + lane];
+            }
+        }
+
+        auto sum = .0f;
+        for(; i < size; i++) {
+            sum += first[i] * first[i];
+        }
+
+        return std::accumulate(partial, partial + SUM_LANES, sum);
     }
 
     std::pair<int, float> _linearBinsInterpolation(float phi, float bandwidth, int bins) {
@@ -21,18 +49,254 @@ namespace {
 
         return std::pair<int, float>(lbin, (1 - distance / bandwidth));
     }
+
+    //grid layout and cell size are compile-time for the common layouts, 0 means they are taken from arguments
+    template<int HistoNums = 0, int Bins = 0, bool Is3LInterp = false, int HistoSize = 0>
+    void _histogrid(float* descriptor, const descriptors::Gradients& gradients, int pR, int pC, float angle,
+                    int histoSize, int histoNums, int bins, float sigma,
+                    borders::BorderTypes border, bool is3LInterp) {
+        constexpr auto isStatic = HistoNums > 0;
+        histoSize = HistoSize > 0 ? HistoSize : histoSize;
+        histoNums = isStatic ? HistoNums : histoNums;
+        bins = isStatic ? Bins : bins;
+        is3LInterp = isStatic ? Is3LInterp : histoNums > 1 && is3LInterp;
+
+        const auto &magnitude = gradients.magnitude;
+        const auto &phi = gradients.phi;
+
+        auto twoPi = (float) (2 * M_PI);
+        auto bandwidth = twoPi / bins;
+        auto blockSize = histoSize * histoNums;
+        auto hBlockSize = blockSize / 2;
+        auto hHistoSize = (float) histoSize / 2;
+
+        //fixed-size local accumulator does not alias the output
+        std::array<float, isStatic ? HistoNums * HistoNums * Bins : 1> accumulator{};
+        auto* histogram = isStatic ? accumulator.data() : descriptor;
+        if(!isStatic) {
+            std::fill(descriptor, descriptor + histoNums * histoNums * bins, 0);
+        }
+
+        auto fCos = std::cos(angle);
+        auto fSin = std::sin(angle);
+
+        //phi is in [0; 2pi], so with the angle wrapped into the same range one branch per side is enough
+        auto phiShift = angle - twoPi * std::floor(angle / twoPi);
+
+        auto fBorder = borders::get(border);
+        auto isInside = pR - hBlockSize >= 0 && pR - hBlockSize + blockSize <= magnitude.height()
+                && pC - hBlockSize >= 0 && pC - hBlockSize + blockSize <= magnitude.width();
+
+        //separable weights: gaussian2d(sigma, size)[row][col] == gaussian1d(sigma, size)[row] * gaussian1d(sigma, size)[col]
+        auto gaussian = kernels::gaussian1d(sigma, blockSize);
+        auto* weights = gaussian.data();
+
+        for(auto row = 0; row < blockSize; row++) {
+            auto rR = row - hBlockSize;
+            auto* magnitudes = isInside ? magnitude.ptr(pR + rR) + pC : nullptr;
+            auto* phis = isInside ? phi.ptr(pR + rR) + pC : nullptr;
+
+            for(auto col = 0; col < blockSize; col++) {
+                auto rC = col - hBlockSize;
+
+                int r = rR * fCos - rC * fSin + hBlockSize;
+                int c = rC * fCos + rR * fSin + hBlockSize;
+
+                if(r < 0 || r >= blockSize || c < 0 || c >= blockSize) continue;
+
+                auto magnitudeVal = weights[row] * weights[col]
+                        * (isInside ? magnitudes[rC] : fBorder(pR + rR, pC + rC, magnitude));
+                auto phiVal = (isInside ? phis[rC] : fBorder(pR + rR, pC + rC, phi)) - phiShift;
+
+                if(phiVal < 0) phiVal += twoPi;
+                if(phiVal >= twoPi) phiVal -= twoPi;
+
+                auto interp = _linearBinsInterpolation(phiVal, bandwidth, bins);
+                auto lBin = interp.first, rBin = (interp.first + 1 == bins) ? 0 : interp.first + 1;
+                auto lValue = interp.second * magnitudeVal, rValue = (1 - interp.second) * magnitudeVal;
+
+                auto r0 = r / histoSize;
+                auto c0 = c / histoSize;
+
+                if(is3LInterp) {
+                    auto cr0 = r0 * histoSize + hHistoSize;
+                    auto cc0 = c0 * histoSize + hHistoSize;
+
+                    //neighbour cells are at most one step outside the grid
+                    auto wrap = [histoNums](int cell) {
+                        return cell < 0 ? cell + histoNums : (cell >= histoNums ? cell - histoNums : cell);
+                    };
+
+                    for(auto rI = 0; rI <= 1; rI++) {
+                        auto rh = r0 + ((r < cr0)? -1 : 1) * rI;
+                        auto rw = 1 - std::fabs(r - rh * histoSize - hHistoSize) / histoSize;
+                        rh = wrap(rh);
+
+                        for(auto cI = 0; cI <= 1; cI++) {
+                            auto ch = c0 + ((c < cc0)? -1 : 1) * cI;
+                            auto cw = 1 - std::fabs(c - ch * histoSize - hHistoSize) / histoSize;
+                            auto weight = rw * cw;
+                            ch = wrap(ch);
+
+                            auto histoBin = (rh * histoNums + ch) * bins;
+                            histogram[histoBin + lBin] += weight * lValue;
+                            histogram[histoBin + rBin] += weight * rValue;
+                        }
+                    }
+                } else {
+                    auto histoBin = (r0 * histoNums + c0) * bins;
+                    histogram[histoBin + lBin] += lValue;
+                    histogram[histoBin + rBin] += rValue;
+                }
+            }
+        }
+
+        if(isStatic) {
+            std::copy(std::begin(accumulator), std::end(accumulator), descriptor);
+        }
+    }
+
+    template<int HistoSize>
+    void _histogrid44(float* descriptor, const descriptors::Gradients& gradients, int pR, int pC, float angle,
+                      float sigma, borders::BorderTypes border, bool is3LInterp, int histoSize = HistoSize) {
+        using namespace descriptors;
+
+        if(is3LInterp) {
+            _histogrid<D_HISTO_NUMS, D_BINS, true, HistoSize>(descriptor, gradients, pR, pC, angle, histoSize,
+                                                              D_HISTO_NUMS, D_BINS, sigma, border, true);
+        } else {
+            _histogrid<D_HISTO_NUMS, D_BINS, false, HistoSize>(descriptor, gradients, pR, pC, angle, histoSize,
+                                                               D_HISTO_NUMS, D_BINS, sigma, border, false);
+        }
+    }
+
+    template<typename T, typename G>
+    std::vector<float> _orientations(const T& point, const G& source, int pR, int pC,
+                                     int blockSize, float sigma, borders::BorderTypes border) {
+        std::vector<float> angles;
+
+        descriptors::Descriptor<T> base(point, descriptors::ORI_BINS);
+        descriptors::histogrid(base.data.get(), source, pR, pC, .0f, blockSize, 1, descriptors::ORI_BINS, sigma, border);
+
+        for(auto index : descriptors::peaks(base, descriptors::ORI_PEAK_RATIO, 2)) {
+            angles.push_back(_parabolic3bfit(base, index) * 2 * M_PI / base.size);
+        }
+
+        return angles;
+    }
+
+    template<typename G>
+    std::vector<float> _rOrientations(const detectors::Point& point, const G& source,
+                                      int histoSize, int histoNums, borders::BorderTypes border) {
+        auto blockSize = histoNums * histoSize;
+
+        return _orientations(point, source, point.row, point.col, blockSize, 5 * std::log10(blockSize), border);
+    }
+
+    template<typename G>
+    std::vector<float> _sOrientations(const detectors::SPoint& point, const G& source,
+                                      borders::BorderTypes border) {
+        return _orientations(point, source, point.localRow, point.localCol, 3 * descriptors::ORI_SIGMA_C * point.sigma,
+                             descriptors::ORI_SIGMA_C * point.sigma, border);
+    }
+
+    template<typename G>
+    std::vector<descriptors::RiDescriptor> _rhistogrid(const detectors::Point& point, const G& source,
+                                                       int histoSize, int histoNums, int bins,
+                                                       borders::BorderTypes border, bool is3LInterp) {
+        std::vector<descriptors::RiDescriptor> descriptors;
+        auto descriptorSize = histoNums * histoNums * bins;
+        auto sigma = 5 * std::log10(histoNums * histoSize);
+
+        for(auto angle : _rOrientations(point, source, histoSize, histoNums, border)) {
+            descriptors.emplace_back(detectors::RPoint{point.row, point.col, point.value, angle}, descriptorSize);
+            descriptors::histogrid(descriptors.back().data.get(), source, point.row, point.col, angle,
+                                   histoSize, histoNums, bins, sigma, border, is3LInterp);
+        }
+
+        return descriptors;
+    }
+
+    template<typename G>
+    std::vector<descriptors::SiDescriptor> _shistogrid(detectors::SPoint point, const G& source,
+                                                       int histoSize, int histoNums, int bins,
+                                                       borders::BorderTypes border, bool is3LInterp) {
+        std::vector<descriptors::SiDescriptor> descriptors;
+        auto scaleHistoSize = histoSize * (int) std::roundf(point.sigma);
+        auto scaleBlockSize = scaleHistoSize * histoNums;
+        auto descriptorSize = histoNums * histoNums * bins;
+
+        for(auto angle : _sOrientations(point, source, border)) {
+            point.angle = angle;
+            descriptors.emplace_back(point, descriptorSize);
+            descriptors::histogrid(descriptors.back().data.get(), source, point.localRow, point.localCol, angle,
+                                   scaleHistoSize, histoNums, bins, descriptors::MAGNITUDE_SIGMA_C * scaleBlockSize,
+                                   border, is3LInterp);
+        }
+
+        return descriptors;
+    }
+
+    //orientations of every point in parallel, returns the first output slot of every point
+    template<typename P, typename O>
+    std::vector<int> _slots(const std::vector<P>& points, std::vector<std::vector<float>>& angles,
+                            int threads, O&& orientations) {
+        angles.resize(points.size());
+        parallel::forEach(points.size(), threads, [&](int i) {
+            angles[i] = orientations(i);
+        });
+
+        std::vector<int> slots(points.size() + 1, 0);
+        for(auto i = 0; i < points.size(); i++) {
+            slots[i + 1] = slots[i] + angles[i].size();
+        }
+
+        return slots;
+    }
+
+    //gradients of every pyramid layer referenced by points, points are expected to be grouped by layer
+    std::vector<descriptors::Gradients> _layerGradients(const std::vector<detectors::SPoint>& points,
+                                                        const std::vector<pyramids::Octave>& gpyramid,
+                                                        std::vector<int>& layerOf,
+                                                        borders::BorderTypes border, int threads) {
+        std::vector<int> firsts;
+        layerOf.resize(points.size());
+
+        for(auto i = 0; i < points.size(); i++) {
+            if(i == 0 || points[i].octave != points[i - 1].octave || points[i].layer != points[i - 1].layer) {
+                firsts.push_back(i);
+            }
+            layerOf[i] = firsts.size() - 1;
+        }
+
+        std::vector<descriptors::Gradients> gradients(firsts.size());
+        parallel::forEach(firsts.size(), threads, [&](int i) {
+            const auto &point = points[firsts[i]];
+            gradients[i] = descriptors::gradients(filters::sobel(gpyramid[point.octave].layers()[point.layer].img, border));
+        }, 1);
+
+        return gradients;
+    }
 }
 
 std::unique_ptr<float[]> descriptors::histogrid(const std::pair<Img, Img>& sobel, int pR, int pC, float angle,
                                                 int histoSize, int histoNums, int bins, float sigma,
                                                 borders::BorderTypes border, bool is3LInterp) {
+    auto descriptor = std::make_unique<float[]>(histoNums * histoNums * bins);
+    histogrid(descriptor.get(), sobel, pR, pC, angle, histoSize, histoNums, bins, sigma, border, is3LInterp);
+
+    return descriptor;
+}
+
+void descriptors::histogrid(float* descriptor, const std::pair<Img, Img>& sobel, int pR, int pC, float angle,
+                            int histoSize, int histoNums, int bins, float sigma,
+                            borders::BorderTypes border, bool is3LInterp) {
     auto bandwidth = 2 * M_PI / bins;
     auto blockSize = histoSize * histoNums;
     auto hBlockSize = blockSize / 2;
 
     auto descriptorSize = histoNums * histoNums * bins;
-    auto descriptor = std::make_unique<float[]>(descriptorSize);
-    std::fill(descriptor.get(), descriptor.get() + descriptorSize, 0);
+    std::fill(descriptor, descriptor + descriptorSize, 0);
 
     auto fCos = std::cos(angle);
     auto fSin = std::sin(angle);
@@ -101,8 +365,44 @@ std::unique_ptr<float[]> descriptors::histogrid(const std::pair<Img, Img>& sobel
             }
         }
     }
+}
 
-    return descriptor;
+descriptors::Gradients descriptors::gradients(const std::pair<Img, Img>& sobel) {
+    auto phi = filters::phi(sobel.first, sobel.second);
+
+    //orientation stays float rather than a quantized bin map: the bin of a sample depends on phi minus
+    //the keypoint angle, so it can only be quantized after the per-keypoint rotation
+    //shift to [0; 2pi] once instead of for every sample
+    std::transform(phi.data(), phi.data() + phi.dataSize(), phi.data(), [](auto value) {
+        return value + (float) M_PI;
+    });
+
+    return {filters::magnitude(sobel.first, sobel.second), std::move(phi)};
+}
+
+void descriptors::histogrid(float* descriptor, const Gradients& gradients, int pR, int pC, float angle,
+                            int histoSize, int histoNums, int bins, float sigma,
+                            borders::BorderTypes border, bool is3LInterp) {
+    if(histoNums == D_HISTO_NUMS && bins == D_BINS) {
+        //cell sizes of the default descriptor and of sift keypoints up to sigma 4
+        switch(histoSize) {
+            case D_HISTO_SIZE:
+                return _histogrid44<D_HISTO_SIZE>(descriptor, gradients, pR, pC, angle, sigma, border, is3LInterp);
+            case 2 * D_HISTO_SIZE:
+                return _histogrid44<2 * D_HISTO_SIZE>(descriptor, gradients, pR, pC, angle, sigma, border, is3LInterp);
+            case 3 * D_HISTO_SIZE:
+                return _histogrid44<3 * D_HISTO_SIZE>(descriptor, gradients, pR, pC, angle, sigma, border, is3LInterp);
+            case 4 * D_HISTO_SIZE:
+                return _histogrid44<4 * D_HISTO_SIZE>(descriptor, gradients, pR, pC, angle, sigma, border, is3LInterp);
+            default:
+                return _histogrid44<0>(descriptor, gradients, pR, pC, angle, sigma, border, is3LInterp, histoSize);
+        }
+    } else if(histoNums == 1 && bins == ORI_BINS) {
+        _histogrid<1, ORI_BINS, false>(descriptor, gradients, pR, pC, angle, histoSize,
+                                       histoNums, bins, sigma, border, is3LInterp);
+    } else {
+        _histogrid(descriptor, gradients, pR, pC, angle, histoSize, histoNums, bins, sigma, border, is3LInterp);
+    }
 }
 
 std::vector<descriptors::BDescriptor> descriptors::bDescriptors(const std::vector<detectors::Point>& points,
@@ -114,98 +414,228 @@ std::vector<descriptors::BDescriptor> descriptors::bDescriptors(const std::vecto
     auto blockSize = histoSize * histoNums;
     auto sigma = std::log10(blockSize);
     auto descriptorSize = histoNums * histoNums * bins;
+    auto grads = gradients(sobel);
 
     for(const auto &point : points) {
-        descriptors.emplace_back(point, descriptorSize, histogrid(sobel, point.row, point.col, 0, histoSize
-                                                                  , histoNums, bins, sigma, border, is3LInterp));
+        descriptors.emplace_back(point, descriptorSize);
+        histogrid(descriptors.back().data.get(), grads, point.row, point.col, 0, histoSize, histoNums, bins, sigma,
+                  border, is3LInterp);
     }
 
     return descriptors;
 }
 
-std::vector<descriptors::RiDescriptor> descriptors::rhistogrid(const detectors::Point& point, const std::pair<Img, Img>& sobel,
-                                                               int histoSize, int histoNums, int bins,
-                                                               borders::BorderTypes border, bool is3LInterp) {
-    std::vector<RiDescriptor> descriptors;
-    auto blockSize = histoNums * histoSize;
-    auto descriptorSize = histoNums * histoNums * bins;
-    auto sigma = 5 * std::log10(blockSize);
+descriptors::BDescriptorSet descriptors::bDescriptorSet(const std::vector<detectors::Point>& points,
+                                                        const std::pair<Img, Img>& sobel, const BSetNormalizeFunction& norm,
+                                                        int histoSize, int histoNums, int bins,
+                                                        borders::BorderTypes border, bool is3LInterp) {
+    BDescriptorSet set(histoNums * histoNums * bins, points.size());
+    auto sigma = std::log10(histoSize * histoNums);
+    auto grads = gradients(sobel);
 
-    BDescriptor base(point, 36, histogrid(sobel, point.row, point.col, .0f, blockSize, 1, 36, sigma, border));
+    for(const auto &point : points) {
+        histogrid(set.push(point), grads, point.row, point.col, 0, histoSize, histoNums, bins, sigma, border, is3LInterp);
+    }
 
-    auto peaksIndexes = peaks(base, ORI_PEAK_RATIO, 2);
+    if(norm) norm(set);
 
-    for(auto index : peaksIndexes) {
-        auto angle = _parabolic3bfit(base, index) * 2 * M_PI / base.size;
-        detectors::RPoint p{point.row, point.col, point.value, angle};
-        descriptors.emplace_back(std::move(p), descriptorSize, histogrid(sobel, point.row, point.col, angle
-                                                                        , histoSize, histoNums, bins, sigma
-                                                                        , border, is3LInterp));
-    }
+    return set;
+}
 
-    return descriptors;
+std::vector<descriptors::RiDescriptor> descriptors::rhistogrid(const detectors::Point& point, const std::pair<Img, Img>& sobel,
+                                                               int histoSize, int histoNums, int bins,
+                                                               borders::BorderTypes border, bool is3LInterp) {
+    return _rhistogrid(point, sobel, histoSize, histoNums, bins, border, is3LInterp);
+}
+
+std::vector<descriptors::RiDescriptor> descriptors::rhistogrid(const detectors::Point& point, const Gradients& gradients,
+                                                               int histoSize, int histoNums, int bins,
+                                                               borders::BorderTypes border, bool is3LInterp) {
+    return _rhistogrid(point, gradients, histoSize, histoNums, bins, border, is3LInterp);
 }
 
 std::vector<descriptors::RiDescriptor> descriptors::riDescriptors(const std::vector<detectors::Point>& points,
                                                                   const std::pair<Img, Img>& sobel,
                                                                   const RiNormalizeFunction& norm, int histoSize,
                                                                   int histoNums, int bins, borders::BorderTypes border,
-                                                                  bool is3LInterp) {
+                                                                  bool is3LInterp, int threads) {
     std::vector<RiDescriptor> descriptors;
-    descriptors.reserve(points.size());
+    std::vector<std::vector<float>> angles;
+    auto descriptorSize = histoNums * histoNums * bins;
+    auto sigma = 5 * std::log10(histoNums * histoSize);
+    auto grads = gradients(sobel);
 
-    for(const auto &point : points) {
-        for(const auto &unnormalized : rhistogrid(point, sobel, histoSize, histoNums, bins, border, is3LInterp)) {
-            descriptors.push_back(norm(unnormalized));
+    auto slots = _slots(points, angles, threads, [&](int i) {
+        return _rOrientations(points[i], grads, histoSize, histoNums, border);
+    });
+
+    descriptors.reserve(slots.back());
+    for(auto i = 0; i < points.size(); i++) {
+        for(auto angle : angles[i]) {
+            descriptors.emplace_back(detectors::RPoint{points[i].row, points[i].col, points[i].value, angle}, descriptorSize);
         }
     }
 
+    parallel::forEach(points.size(), threads, [&](int i) {
+        for(auto slot = slots[i]; slot < slots[i + 1]; slot++) {
+            auto &descriptor = descriptors[slot];
+            histogrid(descriptor.data.get(), grads, points[i].row, points[i].col, descriptor.point.angle,
+                      histoSize, histoNums, bins, sigma, border, is3LInterp);
+            if(norm) descriptor = norm(descriptor);
+        }
+    });
+
     return descriptors;
 }
 
+descriptors::RiDescriptorSet descriptors::riDescriptorSet(const std::vector<detectors::Point>& points,
+                                                          const std::pair<Img, Img>& sobel,
+                                                          const RiSetNormalizeFunction& norm, int histoSize,
+                                                          int histoNums, int bins, borders::BorderTypes border,
+                                                          bool is3LInterp, int threads) {
+    RiDescriptorSet set(histoNums * histoNums * bins);
+    std::vector<std::vector<float>> angles;
+    auto sigma = 5 * std::log10(histoNums * histoSize);
+    auto grads = gradients(sobel);
+
+    auto slots = _slots(points, angles, threads, [&](int i) {
+        return _rOrientations(points[i], grads, histoSize, histoNums, border);
+    });
+
+    set.reserve(slots.back());
+    for(auto i = 0; i < points.size(); i++) {
+        for(auto angle : angles[i]) {
+            set.push({points[i].row, points[i].col, points[i].value, angle});
+        }
+    }
+
+    parallel::forEach(points.size(), threads, [&](int i) {
+        for(auto slot = slots[i]; slot < slots[i + 1]; slot++) {
+            histogrid(set.row(slot), grads, points[i].row, points[i].col, set.point(slot).angle,
+                      histoSize, histoNums, bins, sigma, border, is3LInterp);
+        }
+    });
+
+    if(norm) norm(set);
+
+    return set;
+}
+
 std::vector<descriptors::SiDescriptor> descriptors::shistogrid(detectors::SPoint point, const std::pair<Img, Img>& sobel, int histoSize,
                                                                int histoNums, int bins, borders::BorderTypes border,
                                                                bool is3LInterp) {
+    return _shistogrid(point, sobel, histoSize, histoNums, bins, border, is3LInterp);
+}
+
+std::vector<descriptors::SiDescriptor> descriptors::shistogrid(detectors::SPoint point, const Gradients& gradients, int histoSize,
+                                                               int histoNums, int bins, borders::BorderTypes border,
+                                                               bool is3LInterp) {
+    return _shistogrid(point, gradients, histoSize, histoNums, bins, border, is3LInterp);
+}
+
+std::vector<descriptors::SiDescriptor> descriptors::siDescriptors(const std::vector<detectors::SPoint>& points,
+                                                                  const std::vector<pyramids::Octave>& gpyramid,
+                                                                  const SiNormalizeFunction& norm, int histoSize, int histoNums,
+                                                                  int bins, borders::BorderTypes border, bool is3LInterp,
+                                                                  int threads) {
     std::vector<SiDescriptor> descriptors;
-    auto scaleHistoSize = histoSize * (int) std::roundf(point.sigma);
-    auto scaleBlockSize = scaleHistoSize * histoNums;
+    std::vector<std::vector<float>> angles;
+    std::vector<int> layerOf;
     auto descriptorSize = histoNums * histoNums * bins;
+    auto grads = _layerGradients(points, gpyramid, layerOf, border, threads);
 
-    SiDescriptor base(point, 36, histogrid(sobel, point.localRow, point.localCol
-                                         , .0f, 3 * ORI_SIGMA_C * point.sigma
-                                         , 1, 36, ORI_SIGMA_C * point.sigma, border));
+    auto slots = _slots(points, angles, threads, [&](int i) {
+        return _sOrientations(points[i], grads[layerOf[i]], border);
+    });
 
-    auto peaksIndexes = peaks(base, ORI_PEAK_RATIO, 2);
+    descriptors.reserve(slots.back());
+    for(auto i = 0; i < points.size(); i++) {
+        auto point = points[i];
 
-    for(auto index : peaksIndexes) {
-        auto angle = _parabolic3bfit(base, index) * 2 * M_PI / base.size;
-        point.angle = angle;
-        descriptors.emplace_back(std::move(point), descriptorSize, histogrid(sobel, point.localRow, point.localCol
-                                                                             , angle, scaleHistoSize, histoNums, bins
-                                                                             , MAGNITUDE_SIGMA_C * scaleBlockSize
-                                                                             , border, is3LInterp));
+        for(auto angle : angles[i]) {
+            point.angle = angle;
+            descriptors.emplace_back(point, descriptorSize);
+        }
     }
 
+    parallel::forEach(points.size(), threads, [&](int i) {
+        const auto &point = points[i];
+        auto scaleHistoSize = histoSize * (int) std::roundf(point.sigma);
+
+        for(auto slot = slots[i]; slot < slots[i + 1]; slot++) {
+            auto &descriptor = descriptors[slot];
+            histogrid(descriptor.data.get(), grads[layerOf[i]], point.localRow, point.localCol, descriptor.point.angle,
+                      scaleHistoSize, histoNums, bins, MAGNITUDE_SIGMA_C * scaleHistoSize * histoNums, border, is3LInterp);
+            if(norm) descriptor = norm(descriptor);
+        }
+    });
+
     return descriptors;
 }
 
-std::vector<descriptors::SiDescriptor> descriptors::siDescriptors(const std::vector<detectors::SPoint>& points,
-                                                                  const std::vector<pyramids::Octave>& gpyramid,
-                                                                  const SiNormalizeFunction& norm, int histoSize, int histoNums,
-                                                                  int bins, borders::BorderTypes border, bool is3LInterp) {
-    std::vector<SiDescriptor> descriptors;
-    descriptors.reserve(points.size());
+descriptors::SiDescriptorSet descriptors::siDescriptorSet(const std::vector<detectors::SPoint>& points,
+                                                          const std::vector<pyramids::Octave>& gpyramid,
+                                                          const SiSetNormalizeFunction& norm, int histoSize, int histoNums,
+                                                          int bins, borders::BorderTypes border, bool is3LInterp,
+                                                          int threads) {
+    SiDescriptorSet set(histoNums * histoNums * bins);
+    std::vector<std::vector<float>> angles;
+    std::vector<int> layerOf;
+    auto grads = _layerGradients(points, gpyramid, layerOf, border, threads);
+
+    auto slots = _slots(points, angles, threads, [&](int i) {
+        return _sOrientations(points[i], grads[layerOf[i]], border);
+    });
+
+    set.reserve(slots.back());
+    for(auto i = 0; i < points.size(); i++) {
+        auto point = points[i];
+
+        for(auto angle : angles[i]) {
+            point.angle = angle;
+            set.push(point);
+        }
+    }
 
-    for(auto ptIt = std::begin(points), end = std::end(points); ptIt != end;) {
-        auto o = ptIt->octave, l = ptIt->layer;
-        auto sobel = filters::sobel(gpyramid[o].layers()[l].img, border);
+    parallel::forEach(points.size(), threads, [&](int i) {
+        const auto &point = points[i];
+        auto scaleHistoSize = histoSize * (int) std::roundf(point.sigma);
 
-        for(;o == ptIt->octave && l == ptIt->layer && ptIt != end; ptIt++) {
-            for(const auto &unnormalized : shistogrid(*ptIt, sobel, histoSize, histoNums, bins, border, is3LInterp)) {
-                descriptors.push_back(norm(unnormalized));
-            }
+        for(auto slot = slots[i]; slot < slots[i + 1]; slot++) {
+            histogrid(set.row(slot), grads[layerOf[i]], point.localRow, point.localCol, set.point(slot).angle,
+                      scaleHistoSize, histoNums, bins, MAGNITUDE_SIGMA_C * scaleHistoSize * histoNums, border, is3LInterp);
+        }
+    });
+
+    if(norm) norm(set);
+
+    return set;
+}
+
+void descriptors::siftNormalize(float* data, int count, int stride, int dimension, float threshold) {
+    for(auto i = 0; i < count; i++) {
+        auto* first = data + i * stride;
+
+        auto sumSq = _sumSq(first, dimension);
+        if(sumSq <= 0) continue;
+
+        auto scale = 1 / std::sqrt(sumSq);
+        for(auto j = 0; j < dimension; j++) {
+            first[j] = std::min(first[j] * scale, threshold);
+        }
+
+        scale = 1 / std::sqrt(_sumSq(first, dimension));
+        for(auto j = 0; j < dimension; j++) {
+            first[j] *= scale;
         }
     }
+}
 
-    return descriptors;
+float descriptors::distance(const float* descriptor1, const float* descriptor2, int size) {
+    auto distance = .0f;
+    for(auto i = 0; i < size; i++) {
+        distance += std::pow(descriptor1[i] - descriptor2[i], 2);
+    }
+
+    return distance;
 }
@@ -3,35 +3,28 @@
 using namespace pi;
 
 namespace {
-    std::vector<detectors::Point> _extractPoints(const Img& src, int patchShift, float threshold,
-                                                 const borders::Function& fBorder) {
-        std::vector<detectors::Point> points;
-
-        for(auto row = 0, height = src.height(); row < height; row++) {
-            for(auto col = 0, width = src.width(); col < width; col++) {
-                auto isMax = true;
-                const auto &pixel = *src.at(row, col);
-
-                if(pixel < threshold) continue;
-
-                for(auto kR = -patchShift; kR <= patchShift && isMax; kR++) {
-                    for(auto kC = -patchShift; kC <= patchShift; kC++) {
-                        if(kR == 0 && kC == 0) continue; //only environs
+    struct _Max {
+        float value;
+        int count;
+    };
 
-                        if(pixel <= fBorder(row + kR, col + kC, src)) {
-                            isMax = false;
-                            break;
-                        };
-                    }
-                }
+    _Max _combine(const _Max& m1, const _Max& m2) {
+        if(m1.value > m2.value) return m1;
+        if(m2.value > m1.value) return m2;
+        return {m1.value, m1.count + m2.count};
+    }
 
-                if(isMax) {
-                    points.push_back({row, col, pixel});
-                }
-            }
+    void _slidingMax(const _Max* src, int length, int size, _Max* dst, _Max* prefix, _Max* suffix) {
+        //van Herk/Gil-Werman: constant number of comparisons per element regardless of window size
+        for(auto i = 0; i < length; i++) {
+            prefix[i] = (i % size == 0) ? src[i] : _combine(prefix[i - 1], src[i]);
+        }
+        for(auto i = length - 1; i >= 0; i--) {
+            suffix[i] = (i == length - 1 || (i + 1) % size == 0) ? src[i] : _combine(suffix[i + 1], src[i]);
+        }
+        for(auto i = 0, windows = length - size + 1; i < windows; i++) {
+            dst[i] = (i % size == 0) ? suffix[i] : _combine(suffix[i], prefix[i + size - 1]);
         }
-
-        return points;
     }
 
     bool _isExtremum(std::initializer_list<std::reference_wrapper<const Img>> images, int r, int c, float value,
@@ -71,6 +64,138 @@ namespace {
 
         return {A, B, C};
     }
+
+    //Bresenham circle of radius 3
+    constexpr int FAST_CIRCLE = 16;
+    constexpr int FAST_RADIUS = 3;
+    constexpr int FAST_OFFSETS[FAST_CIRCLE][2] = {{-3, 0}, {-3, 1}, {-2, 2}, {-1, 3}, {0, 3}, {1, 3}, {2, 2}, {3, 1},
+                                                  {3, 0}, {3, -1}, {2, -2}, {1, -3}, {0, -3}, {-1, -3}, {-2, -2}, {-3, -1}};
+
+    bool _hasArc(unsigned mask, int arc) {
+        auto doubled = mask | (mask << FAST_CIRCLE);
+        auto arcs = doubled;
+
+        for(auto i = 1; i < arc; i++) {
+            arcs &= doubled >> i;
+        }
+
+        return (arcs & 0xFFFF) != 0;
+    }
+
+    float _fastScore(const float* differences, int arc) {
+        //the largest threshold for which an arc of brighter or darker pixels still exists
+        auto score = -FLT_MAX;
+
+        for(auto start = 0; start < FAST_CIRCLE; start++) {
+            auto brighter = FLT_MAX, darker = FLT_MAX;
+
+            for(auto i = start; i < start + arc; i++) {
+                auto difference = differences[i % FAST_CIRCLE];
+                brighter = std::min(brighter, difference);
+                darker = std::min(darker, -difference);
+            }
+
+            score = std::max(score, std::max(brighter, darker));
+        }
+
+        return score;
+    }
+
+    int _hessianSize(int octave, int layer) {
+        return 3 * ((1 << (octave + 1)) * (layer + 1) + 1);
+    }
+
+    Img _hessianLayer(const Integral& integral, int octave, int layer) {
+        auto step = 1 << octave;
+        auto size = _hessianSize(octave, layer);
+        auto lobe = size / 3, border = (size - 1) / 2;
+        auto area = (float) size * size;
+
+        Img responses(integral.height() / step, integral.width() / step, 1);
+
+        for(auto r = 0, height = responses.height(); r < height; r++) {
+            auto* values = responses.ptr(r);
+
+            for(auto c = 0, width = responses.width(); c < width; c++) {
+                auto row = r * step, col = c * step;
+
+                auto dxx = integral.box(row - lobe + 1, col - border, 2 * lobe - 1, size)
+                        - 3 * integral.box(row - lobe + 1, col - lobe / 2, 2 * lobe - 1, lobe);
+                auto dyy = integral.box(row - border, col - lobe + 1, size, 2 * lobe - 1)
+                        - 3 * integral.box(row - lobe / 2, col - lobe + 1, lobe, 2 * lobe - 1);
+                auto dxy = integral.box(row - lobe, col + 1, lobe, lobe)
+                        + integral.box(row + 1, col - lobe, lobe, lobe)
+                        - integral.box(row - lobe, col - lobe, lobe, lobe)
+                        - integral.box(row + 1, col + 1, lobe, lobe);
+
+                dxx /= area;
+                dyy /= area;
+                dxy *= detectors::t_hessian::H_DXY_WEIGHT / area;
+
+                values[c] = dxx * dyy - dxy * dxy;
+            }
+        }
+
+        return responses;
+    }
+
+    template<typename T>
+    std::vector<T> _retainBest(const std::vector<T>& points, Size size, const detectors::Budget& budget) {
+        assert(size.width > 0 && size.height > 0);
+        assert(budget.maxPoints >= 0 && budget.gridSize > 0);
+
+        if(points.size() <= budget.maxPoints) {
+            return points;
+        }
+
+        auto gridSize = budget.gridSize;
+        std::vector<std::vector<int>> cells(gridSize * gridSize);
+
+        for(auto i = 0, pSize = (int) points.size(); i < pSize; i++) {
+            auto gR = std::clamp(points[i].row * gridSize / size.height, 0, gridSize - 1);
+            auto gC = std::clamp(points[i].col * gridSize / size.width, 0, gridSize - 1);
+            cells[gR * gridSize + gC].push_back(i);
+        }
+
+        //blobs are extrema of both signs
+        auto isStronger = [&points](int i1, int i2) {
+            auto v1 = std::abs(points[i1].value), v2 = std::abs(points[i2].value);
+            return v1 > v2 || (v1 == v2 && i1 < i2);
+        };
+
+        std::vector<int> kept, spilled;
+        kept.reserve(budget.maxPoints);
+        auto quota = (budget.maxPoints + (int) cells.size() - 1) / (int) cells.size();
+
+        for(auto &cell : cells) {
+            auto last = std::begin(cell) + std::min(quota, (int) cell.size());
+            std::nth_element(std::begin(cell), last, std::end(cell), isStronger);
+            kept.insert(std::end(kept), std::begin(cell), last);
+            spilled.insert(std::end(spilled), last, std::end(cell));
+        }
+
+        //trim rounding excess or give unused quota of sparse cells to the strongest remaining points
+        if(kept.size() > budget.maxPoints) {
+            std::nth_element(std::begin(kept), std::begin(kept) + budget.maxPoints, std::end(kept), isStronger);
+            kept.resize(budget.maxPoints);
+        } else {
+            auto last = std::begin(spilled) + (budget.maxPoints - kept.size());
+            std::nth_element(std::begin(spilled), last, std::end(spilled), isStronger);
+            kept.insert(std::end(kept), std::begin(spilled), last);
+        }
+
+        //keep original order, points of the same octave and layer stay together
+        std::sort(std::begin(kept), std::end(kept));
+
+        std::vector<T> retained;
+        retained.reserve(kept.size());
+
+        for(auto index : kept) {
+            retained.push_back(points[index]);
+        }
+
+        return retained;
+    }
 }
 
 std::vector<detectors::Point> detectors::moravec(const Img& src, int patchSize, float threshold,
@@ -106,7 +231,12 @@ std::vector<detectors::Point> detectors::moravec(const Img& src, int patchSize,
         }
     }
 
-    return _extractPoints(dst, patchShift, threshold, fBorder);
+    return nonMaximumSuppression(dst, patchSize, threshold, border);
+}
+
+std::vector<detectors::Point> detectors::moravec(const Img& src, const Budget& budget, int patchSize, float threshold,
+                                                 borders::BorderTypes border) {
+    return retainBest(moravec(src, patchSize, threshold, border), src.dimensions(), budget);
 }
 
 std::vector<detectors::Point> detectors::harris(const Img& src, int patchSize, float threshold,
@@ -128,7 +258,138 @@ std::vector<detectors::Point> detectors::harris(const Img& src, int patchSize, f
         }
     }
 
-    return _extractPoints(dst, patchSize / 2, threshold, fBorder);
+    return nonMaximumSuppression(dst, patchSize, threshold, border);
+}
+
+std::vector<detectors::Point> detectors::harris(const Img& src, const Budget& budget, int patchSize, float threshold,
+                                                float k, borders::BorderTypes border) {
+    return retainBest(harris(src, patchSize, threshold, k, border), src.dimensions(), budget);
+}
+
+std::vector<detectors::Point> detectors::fast(const Img& src, float threshold, int arc, bool nonmaxSuppression,
+                                              bool score) {
+    assert(src.channels() == 1);
+    assert(threshold > 0);
+    assert(arc >= 9 && arc <= 12);
+
+    auto height = src.height(), width = src.width();
+    auto step = src.step();
+    auto compass = arc / 4;
+    auto isScored = score || nonmaxSuppression;
+
+    int offsets[FAST_CIRCLE];
+    for(auto i = 0; i < FAST_CIRCLE; i++) {
+        offsets[i] = FAST_OFFSETS[i][0] * step + FAST_OFFSETS[i][1];
+    }
+
+    std::vector<Point> points;
+    std::vector<unsigned char> candidates(width, 0);
+    Img scores(isScored ? height : 0, isScored ? width : 0, 1);
+    std::fill(scores.data(), scores.data() + scores.dataSize(), .0f);
+
+    for(auto row = FAST_RADIUS; row < height - FAST_RADIUS; row++) {
+        auto* pixels = src.ptr(row);
+        auto* top = src.ptr(row - FAST_RADIUS);
+        auto* bottom = src.ptr(row + FAST_RADIUS);
+
+        //branchless high-speed test on the compass pixels over the whole row
+        for(auto col = FAST_RADIUS; col < width - FAST_RADIUS; col++) {
+            auto hi = pixels[col] + threshold, lo = pixels[col] - threshold;
+            auto brighter = (top[col] > hi) + (pixels[col + FAST_RADIUS] > hi)
+                    + (bottom[col] > hi) + (pixels[col - FAST_RADIUS] > hi);
+            auto darker = (top[col] < lo) + (pixels[col + FAST_RADIUS] < lo)
+                    + (bottom[col] < lo) + (pixels[col - FAST_RADIUS] < lo);
+            candidates[col] = (brighter >= compass) | (darker >= compass);
+        }
+
+        for(auto col = FAST_RADIUS; col < width - FAST_RADIUS; col++) {
+            if(!candidates[col]) continue;
+
+            auto* pixel = pixels + col;
+            auto brighterMask = 0u, darkerMask = 0u;
+            float differences[FAST_CIRCLE];
+
+            for(auto i = 0; i < FAST_CIRCLE; i++) {
+                differences[i] = pixel[offsets[i]] - *pixel;
+                brighterMask |= (unsigned) (differences[i] > threshold) << i;
+                darkerMask |= (unsigned) (differences[i] < -threshold) << i;
+            }
+
+            if(!_hasArc(brighterMask, arc) && !_hasArc(darkerMask, arc)) continue;
+
+            if(isScored) {
+                *scores.at(row, col) = _fastScore(differences, arc);
+            }
+            if(!nonmaxSuppression) {
+                points.push_back({row, col, isScored ? *scores.at(row, col) : .0f});
+            }
+        }
+    }
+
+    if(nonmaxSuppression) {
+        return nonMaximumSuppression(scores, 3, threshold, borders::BORDER_CONSTANT);
+    }
+
+    return points;
+}
+
+std::vector<detectors::Point> detectors::nonMaximumSuppression(const Img& src, int patchSize, float threshold,
+                                                               borders::BorderTypes border) {
+    assert(src.channels() == 1);
+    assert(patchSize > 0 && patchSize % 2 == 1);
+
+    auto patchShift = patchSize / 2;
+    auto fBorder = borders::get(border);
+    auto height = src.height(), width = src.width();
+    auto pHeight = height + 2 * patchShift, pWidth = width + 2 * patchShift;
+    auto length = std::max(pHeight, pWidth);
+
+    std::vector<_Max> line(length), prefix(length), suffix(length), column(pHeight);
+    std::vector<_Max> rows(pHeight * width);
+
+    //pass over rows (with borders) keeping max value and the number of its occurrences in the window
+    for(auto r = 0; r < pHeight; r++) {
+        auto row = r - patchShift;
+
+        for(auto c = 0; c < pWidth; c++) {
+            auto col = c - patchShift;
+            auto isInside = row >= 0 && row < height && col >= 0 && col < width;
+            line[c] = {isInside ? *src.at(row, col) : fBorder(row, col, src), 1};
+        }
+
+        _slidingMax(line.data(), pWidth, patchSize, rows.data() + r * width, prefix.data(), suffix.data());
+    }
+
+    std::vector<_Max> maxes(height * width);
+
+    //pass over columns
+    for(auto col = 0; col < width; col++) {
+        for(auto r = 0; r < pHeight; r++) {
+            line[r] = rows[r * width + col];
+        }
+
+        _slidingMax(line.data(), pHeight, patchSize, column.data(), prefix.data(), suffix.data());
+
+        for(auto row = 0; row < height; row++) {
+            maxes[row * width + col] = column[row];
+        }
+    }
+
+    std::vector<Point> points;
+
+    //pixel is a strict maximum if it is the only one with the max value in its environs
+    for(auto row = 0; row < height; row++) {
+        auto* pixels = src.ptr(row);
+        auto* max = maxes.data() + row * width;
+
+        for(auto col = 0; col < width; col++) {
+            if(pixels[col] >= threshold && max[col].value == pixels[col] && max[col].count == 1) {
+                points.push_back({row, col, pixels[col]});
+            }
+        }
+    }
+
+    return points;
 }
 
 std::vector<detectors::SPoint> detectors::harris(const std::vector<pyramids::Octave>& dog,
@@ -154,6 +415,14 @@ std::vector<detectors::SPoint> detectors::harris(const std::vector<pyramids::Oct
     return points;
 }
 
+std::vector<detectors::SPoint> detectors::harris(const std::vector<pyramids::Octave>& dog,
+                                                 const std::vector<SPoint>& blobs, const Budget& budget,
+                                                 float threshold, float k, borders::BorderTypes border) {
+    assert(!dog.empty());
+
+    return retainBest(harris(dog, blobs, threshold, k, border), dog.front().layers().front().img.dimensions(), budget);
+}
+
 std::vector<detectors::SPoint> detectors::shiTomasi(const std::vector<pyramids::Octave>& dog,
                                                     const std::vector<SPoint>& blobs, float threshold,
                                                     borders::BorderTypes border) {
@@ -177,6 +446,14 @@ std::vector<detectors::SPoint> detectors::shiTomasi(const std::vector<pyramids::
     return points;
 }
 
+std::vector<detectors::SPoint> detectors::shiTomasi(const std::vector<pyramids::Octave>& dog,
+                                                    const std::vector<SPoint>& blobs, const Budget& budget,
+                                                    float threshold, borders::BorderTypes border) {
+    assert(!dog.empty());
+
+    return retainBest(shiTomasi(dog, blobs, threshold, border), dog.front().layers().front().img.dimensions(), budget);
+}
+
 std::vector<detectors::SPoint> detectors::blobs(const std::vector<pyramids::Octave>& dog, float contrastThreshold,
                                                 borders::BorderTypes border) {
     std::vector<SPoint> blobs;
@@ -213,6 +490,97 @@ std::vector<detectors::SPoint> detectors::blobs(const std::vector<pyramids::Octa
     return blobs;
 }
 
+std::vector<detectors::SPoint> detectors::blobs(const std::vector<pyramids::Octave>& dog, const Budget& budget,
+                                                float contrastThreshold, borders::BorderTypes border) {
+    assert(!dog.empty());
+
+    return retainBest(blobs(dog, contrastThreshold, border), dog.front().layers().front().img.dimensions(), budget);
+}
+
+std::vector<detectors::SPoint> detectors::hessian(const Img& src, int layers, int octaves, float threshold) {
+    return hessian(Integral(src), layers, octaves, threshold);
+}
+
+std::vector<detectors::SPoint> detectors::hessian(const Integral& integral, int layers, int octaves, float threshold) {
+    assert(layers > 0 && octaves > 0);
+
+    std::vector<SPoint> points;
+    auto height = integral.height(), width = integral.width();
+    auto gOctaves = pyramids::logOctavesCount(std::min(height, width));
+
+    for(auto o = 0; o < octaves && _hessianSize(o, t_hessian::H_LAYERS - 1) <= std::min(height, width); o++) {
+        auto step = 1 << o;
+
+        std::vector<Img> responses;
+        responses.reserve(t_hessian::H_LAYERS);
+        for(auto l = 0; l < t_hessian::H_LAYERS; l++) {
+            responses.push_back(_hessianLayer(integral, o, l));
+        }
+
+        for(auto l = 1; l < t_hessian::H_LAYERS - 1; l++) {
+            auto &layer = responses[l];
+            auto shift = _hessianSize(o, l + 1) / 2 / step + 1;
+            auto sigmaGlobal = 1.2f * _hessianSize(o, l) / 9;
+
+            //place the point on the closest layer of gaussian pyramid with the given number of layers
+            auto index = std::max(0, (int) std::lround(std::log2(sigmaGlobal / pyramids::Octave::SIGMA_ZERO) * layers));
+            auto gOctave = index / layers, gLayer = index % layers;
+            if(gOctave >= gOctaves) continue;
+
+            for(auto r = shift, rEnd = layer.height() - shift; r < rEnd; r++) {
+                for(auto c = shift, cEnd = layer.width() - shift; c < cEnd; c++) {
+                    auto value = *layer.at(r, c);
+                    if(value < threshold) continue;
+
+                    auto isMax = true;
+                    for(auto i = -1; i <= 1 && isMax; i++) {
+                        for(auto kR = -1; kR <= 1 && isMax; kR++) {
+                            for(auto kC = -1; kC <= 1; kC++) {
+                                if(i == 0 && kR == 0 && kC == 0) continue;
+
+                                if(value <= *responses[l + i].at(r + kR, c + kC)) {
+                                    isMax = false;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+
+                    if(isMax) {
+                        auto row = r * step, col = c * step;
+                        auto gScale = 1 << gOctave;
+
+                        points.push_back({
+                                             row, col, value, 0,
+                                             std::min(row / gScale, height / gScale - 1),
+                                             std::min(col / gScale, width / gScale - 1),
+                                             gOctave, gLayer,
+                                             sigmaGlobal / gScale,
+                                             sigmaGlobal
+                                         });
+                    }
+                }
+            }
+        }
+    }
+
+    //descriptors are computed layer by layer
+    std::stable_sort(std::begin(points), std::end(points), [](const auto& p1, const auto& p2) {
+        return p1.octave < p2.octave || (p1.octave == p2.octave && p1.layer < p2.layer);
+    });
+
+    return points;
+}
+
+std::vector<detectors::Point> detectors::retainBest(const std::vector<Point>& points, Size size, const Budget& budget) {
+    return _retainBest(points, size, budget);
+}
+
+std::vector<detectors::SPoint> detectors::retainBest(const std::vector<SPoint>& points, Size size,
+                                                     const Budget& budget) {
+    return _retainBest(points, size, budget);
+}
+
 float detectors::utils::harris(const std::array<float, 3>& values, float k) {
 
     auto A = values[0], B = values[1], C = values[2];
@@ -249,3 +617,94 @@ std::vector<detectors::Point> detectors::adaptiveNonMaximumSuppresion(const std:
 
     return filtered;
 }
+
+std::vector<detectors::Point> detectors::adaptiveNonMaximumSuppresion(const std::vector<Point>& points,
+                                                                      int quantity, float coefficient) {
+    assert(quantity >= 0);
+    assert(coefficient > 0);
+
+    if(points.size() <= quantity) {
+        return points;
+    }
+
+    std::vector<Point> sorted(points);
+    std::stable_sort(std::begin(sorted), std::end(sorted), [](const auto& p1, const auto& p2) {
+        return p1.value > p2.value;
+    });
+
+    auto size = (int) sorted.size();
+    auto rows = std::minmax_element(std::begin(sorted), std::end(sorted), [](const auto& p1, const auto& p2) {
+        return p1.row < p2.row;
+    });
+    auto cols = std::minmax_element(std::begin(sorted), std::end(sorted), [](const auto& p1, const auto& p2) {
+        return p1.col < p2.col;
+    });
+    auto minRow = rows.first->row, minCol = cols.first->col;
+    auto height = rows.second->row - minRow + 1, width = cols.second->col - minCol + 1;
+
+    //about one point per cell
+    auto cellSize = std::max(1, (int) std::sqrt((float) height * width / size));
+    auto gHeight = height / cellSize + 1, gWidth = width / cellSize + 1;
+    std::vector<std::vector<int>> grid(gHeight * gWidth);
+
+    auto cell = [&sorted, minRow, minCol, cellSize](int index) {
+        return std::pair<int, int>((sorted[index].row - minRow) / cellSize, (sorted[index].col - minCol) / cellSize);
+    };
+
+    std::vector<float> radiuses(size, FLT_MAX);
+
+    for(auto i = 0, inserted = 0; i < size; i++) {
+        //grid contains only points strong enough to suppress the current one
+        for(;inserted < size && sorted[inserted].value * coefficient > sorted[i].value; inserted++) {
+            auto c = cell(inserted);
+            grid[c.first * gWidth + c.second].push_back(inserted);
+        }
+
+        auto c = cell(i);
+        auto best = FLT_MAX;
+
+        for(auto ring = 0, rings = std::max(gHeight, gWidth); ring < rings && inserted > 0; ring++) {
+            for(auto dR = -ring; dR <= ring; dR++) {
+                auto gR = c.first + dR;
+                if(gR < 0 || gR >= gHeight) continue;
+
+                for(auto dC = -ring; dC <= ring; dC += (std::abs(dR) == ring) ? 1 : 2 * ring) {
+                    auto gC = c.second + dC;
+                    if(gC < 0 || gC >= gWidth) continue;
+
+                    for(auto index : grid[gR * gWidth + gC]) {
+                        if(index == i) continue;
+
+                        auto dRow = (float) (sorted[index].row - sorted[i].row);
+                        auto dCol = (float) (sorted[index].col - sorted[i].col);
+                        best = std::min(best, dRow * dRow + dCol * dCol);
+                    }
+                }
+            }
+
+            //points from next rings are at least ring * cellSize away
+            auto bound = (float) ring * cellSize;
+            if(best <= bound * bound) break;
+        }
+
+        if(best < FLT_MAX) {
+            radiuses[i] = std::sqrt(best);
+        }
+    }
+
+    std::vector<int> indexes(size);
+    std::iota(std::begin(indexes), std::end(indexes), 0);
+    std::partial_sort(std::begin(indexes), std::begin(indexes) + quantity, std::end(indexes),
+                      [&radiuses](int i1, int i2) {
+        return radiuses[i1] > radiuses[i2] || (radiuses[i1] == radiuses[i2] && i1 < i2);
+    });
+
+    std::vector<Point> filtered;
+    filtered.reserve(quantity);
+
+    for(auto i = 0; i < quantity; i++) {
+        filtered.push_back(sorted[indexes[i]]);
+    }
+
+    return filtered;
+}
@@ -0,0 +1,58 @@
+#include <guided.h>
+
+using namespace pi;
+
+descriptors::PointGrid::PointGrid(const float* positions, int count, float cell)
+    : _cell(cell)
+    , _minX(0)
+    , _minY(0)
+    , _cols(1)
+    , _rows(1)
+    , _positions(positions, positions + 2 * count)
+    , _indices(count)
+{
+    assert(cell > 0);
+
+    if(count > 0) {
+        auto maxX = -FLT_MAX, maxY = -FLT_MAX;
+        _minX = _minY = FLT_MAX;
+
+        for(auto i = 0; i < count; i++) {
+            _minX = std::min(_minX, positions[2 * i]);
+            _minY = std::min(_minY, positions[2 * i + 1]);
+            maxX = std::max(maxX, positions[2 * i]);
+            maxY = std::max(maxY, positions[2 * i + 1]);
+        }
+
+        //a small cell over a wide spread would allocate mostly empty offsets, so the cell grows instead
+        auto cells = [&]() {
+            return (std::floor((double) (maxX - _minX) / _cell) + 1) * (std::floor((double) (maxY - _minY) / _cell) + 1);
+        };
+        while(cells() > t_guided::G_MAX_CELLS) {
+            _cell *= 2;
+        }
+
+        _cols = (int) ((maxX - _minX) / _cell) + 1;
+        _rows = (int) ((maxY - _minY) / _cell) + 1;
+    }
+
+    auto cellOf = [this](int i) {
+        return (int) ((_positions[2 * i + 1] - _minY) / _cell) * _cols + (int) ((_positions[2 * i] - _minX) / _cell);
+    };
+
+    //counting sort of point indices by cell
+    _offsets.assign(_cols * _rows + 1, 0);
+    for(auto i = 0; i < count; i++) {
+        _offsets[cellOf(i) + 1]++;
+    }
+    std::partial_sum(std::begin(_offsets), std::end(_offsets), std::begin(_offsets));
+
+    std::vector<int> fill(std::begin(_offsets), std::end(_offsets) - 1);
+    for(auto i = 0; i < count; i++) {
+        _indices[fill[cellOf(i)]++] = i;
+    }
+}
+
+int descriptors::PointGrid::size() const {
+    return _indices.size();
+}
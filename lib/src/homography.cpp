@@ -1,3 +1,92 @@
 #include <homography.h>
 
+#include <climits>
+#include <stdexcept>
+
 using namespace pi;
+
+namespace {
+    std::uint64_t _splitmix(std::uint64_t value) {
+        value += 0x9e3779b97f4a7c15ull;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+}
+
+bool transforms::minimalHomography(const float* src, const float* dst, Transform2d& h) {
+    constexpr int N = 8;
+
+    //h33 = 1, two equations per correspondence, solved by gaussian elimination with partial pivoting
+    double A[N][N + 1];
+    for(auto i = 0; i < N / 2; i++) {
+        double x = src[2 * i], y = src[2 * i + 1];
+        double u = dst[2 * i], v = dst[2 * i + 1];
+
+        double row1[] { x, y, 1, 0, 0, 0, -u * x, -u * y, u };
+        double row2[] { 0, 0, 0, x, y, 1, -v * x, -v * y, v };
+
+        std::copy(std::begin(row1), std::end(row1), A[2 * i]);
+        std::copy(std::begin(row2), std::end(row2), A[2 * i + 1]);
+    }
+
+    for(auto c = 0; c < N; c++) {
+        auto pivot = c;
+        for(auto r = c + 1; r < N; r++) {
+            if(std::abs(A[r][c]) > std::abs(A[pivot][c])) pivot = r;
+        }
+
+        if(std::abs(A[pivot][c]) < 1e-10) return false;
+        if(pivot != c) std::swap(A[pivot], A[c]);
+
+        for(auto r = c + 1; r < N; r++) {
+            auto factor = A[r][c] / A[c][c];
+            for(auto k = c; k <= N; k++) {
+                A[r][k] -= factor * A[c][k];
+            }
+        }
+    }
+
+    double x[N];
+    for(auto r = N - 1; r >= 0; r--) {
+        auto sum = A[r][N];
+        for(auto k = r + 1; k < N; k++) {
+            sum -= A[r][k] * x[k];
+        }
+        x[r] = sum / A[r][r];
+    }
+
+    for(auto i = 0; i < T_SIZE; i++) {
+        for(auto j = 0; j < T_SIZE; j++) {
+            h[i][j] = T_SIZE * i + j < N ? (float) x[T_SIZE * i + j] : 1.f;
+        }
+    }
+
+    return std::all_of(std::begin(x), std::end(x), [](auto value) { return std::isfinite(value); });
+}
+
+int transforms::ransacIterations(int inliers, int total, float confidence, int sample) {
+    auto ratio = (double) inliers / total;
+    auto outliers = 1 - std::pow(ratio, sample);
+
+    if(outliers <= 0) return 0;
+    if(outliers >= 1) return INT_MAX;
+
+    return (int) std::min<double>(INT_MAX, std::ceil(std::log(1 - confidence) / std::log(outliers)));
+}
+
+void transforms::sampleIndices(std::uint64_t seed, int iteration, int size, int* indices, int sample) {
+    //rejection sampling below never ends when there are not enough distinct indices
+    if(size < sample) throw std::invalid_argument("homography: cannot sample " + std::to_string(sample)
+                                                  + " indices out of " + std::to_string(size));
+
+    //counter-based stream: the state depends only on the seed and the iteration
+    auto state = _splitmix(seed ^ _splitmix(iteration));
+
+    for(auto k = 0; k < sample; k++) {
+        do {
+            state = _splitmix(state);
+            indices[k] = (int) (((state >> 32) * (std::uint64_t) size) >> 32);
+        } while(std::find(indices, indices + k, indices[k]) != indices + k);
+    }
+}
@@ -0,0 +1,72 @@
+#include <integral.h>
+
+#include <algorithm>
+
+using namespace pi;
+
+Integral::Integral(const Img& src)
+    : _height(src.height())
+    , _width(src.width())
+    , _data(std::make_unique<double[]>((_height + 1) * (_width + 1)))
+{
+    assert(src.channels() == 1);
+
+    auto step = _width + 1;
+    std::fill(_data.get(), _data.get() + step, .0);
+
+    for(auto row = 0; row < _height; row++) {
+        auto* pixels = src.ptr(row);
+        auto* prev = _data.get() + row * step;
+        auto* curr = prev + step;
+        auto sum = .0;
+
+        curr[0] = 0;
+        for(auto col = 0; col < _width; col++) {
+            sum += pixels[col];
+            curr[col + 1] = prev[col + 1] + sum;
+        }
+    }
+}
+
+Integral::Integral(const Integral& integral)
+    : _height(integral._height)
+    , _width(integral._width)
+    , _data(std::make_unique<double[]>((_height + 1) * (_width + 1)))
+{
+    std::copy(integral._data.get(), integral._data.get() + (_height + 1) * (_width + 1), _data.get());
+}
+
+Integral& Integral::operator=(const Integral& integral) {
+    if(this != &integral) {
+        _height = integral._height;
+        _width = integral._width;
+
+        _data = std::make_unique<double[]>((_height + 1) * (_width + 1));
+        std::copy(integral._data.get(), integral._data.get() + (_height + 1) * (_width + 1), _data.get());
+    }
+    return *this;
+}
+
+double Integral::at(int row, int col) const {
+    assert(0 <= row && row <= _height);
+    assert(0 <= col && col <= _width);
+
+    return _data[row * (_width + 1) + col];
+}
+
+float Integral::box(int row, int col, int rows, int cols) const {
+    auto r0 = std::clamp(row, 0, _height), r1 = std::clamp(row + rows, 0, _height);
+    auto c0 = std::clamp(col, 0, _width), c1 = std::clamp(col + cols, 0, _width);
+
+    if(r1 <= r0 || c1 <= c0) return 0;
+
+    return at(r1, c1) - at(r0, c1) - at(r1, c0) + at(r0, c0);
+}
+
+int Integral::width() const {
+    return _width;
+}
+
+int Integral::height() const {
+    return _height;
+}
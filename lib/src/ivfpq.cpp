@@ -0,0 +1,265 @@
+#include <ivfpq.h>
+
+#include <fstream>
+#include <stdexcept>
+
+using namespace pi;
+
+namespace {
+    constexpr char IVF_MAGIC[4] = {'I', 'V', 'F', '1'};
+
+    template<typename V>
+    void _write(std::ofstream& file, const V* data, std::size_t count) {
+        file.write(reinterpret_cast<const char*>(data), sizeof(V) * count);
+    }
+
+    template<typename V>
+    void _read(std::ifstream& file, V* data, std::size_t count) {
+        file.read(reinterpret_cast<char*>(data), sizeof(V) * count);
+    }
+}
+
+descriptors::IvfPq::IvfPq(int dimension, int lists, int subspaces)
+    : _dimension(dimension)
+    , _lists(lists)
+    , _subspaces(subspaces)
+    , _subDimension(dimension / subspaces)
+    , _size(0)
+    , _ids(lists)
+    , _codes(lists)
+{
+    assert(dimension > 0 && lists > 0 && subspaces > 0 && dimension % subspaces == 0);
+}
+
+void descriptors::IvfPq::train(const float* data, int count, int stride, unsigned int seed) {
+    using namespace t_ivfpq;
+
+    assert(!trained() && count >= std::max(_lists, PQ_CENTROIDS));
+
+    std::mt19937 rand{seed};
+    std::vector<int> labels;
+
+    _coarse = clustering::kmeans(data, count, stride, _dimension, _lists, rand, labels);
+
+    //product quantizer is trained on residuals to the coarse centroids
+    std::vector<float> residuals(count * _dimension);
+    for(auto i = 0; i < count; i++) {
+        const auto* row = data + i * stride;
+        const auto* centroid = _coarse.data() + labels[i] * _dimension;
+
+        for(auto j = 0; j < _dimension; j++) {
+            residuals[i * _dimension + j] = row[j] - centroid[j];
+        }
+    }
+
+    _codebooks.resize(_subspaces * PQ_CENTROIDS * _subDimension);
+    for(auto m = 0; m < _subspaces; m++) {
+        auto codebook = clustering::kmeans(residuals.data() + m * _subDimension, count, _dimension, _subDimension,
+                                           PQ_CENTROIDS, rand, labels);
+        std::copy(std::begin(codebook), std::end(codebook),
+                  _codebooks.data() + m * PQ_CENTROIDS * _subDimension);
+    }
+}
+
+void descriptors::IvfPq::_encode(const float* residual, std::uint8_t* code) const {
+    using namespace t_ivfpq;
+
+    for(auto m = 0; m < _subspaces; m++) {
+        code[m] = (std::uint8_t) clustering::nearest(_codebooks.data() + m * PQ_CENTROIDS * _subDimension,
+                                                     PQ_CENTROIDS, _subDimension, residual + m * _subDimension);
+    }
+}
+
+void descriptors::IvfPq::add(const float* data, int count, int stride) {
+    assert(trained());
+
+    std::vector<float> residual(_dimension);
+    std::vector<std::uint8_t> code(_subspaces);
+
+    for(auto i = 0; i < count; i++) {
+        const auto* row = data + i * stride;
+        auto list = clustering::nearest(_coarse.data(), _lists, _dimension, row);
+        const auto* centroid = _coarse.data() + list * _dimension;
+
+        for(auto j = 0; j < _dimension; j++) {
+            residual[j] = row[j] - centroid[j];
+        }
+        _encode(residual.data(), code.data());
+
+        _ids[list].push_back(_size++);
+        _codes[list].insert(std::end(_codes[list]), std::begin(code), std::end(code));
+    }
+}
+
+void descriptors::IvfPq::search(const float* query, int k, int* indices, float* distances, int probes) const {
+    using namespace t_ivfpq;
+
+    assert(trained() && k > 0);
+
+    std::fill(indices, indices + k, -1);
+    std::fill(distances, distances + k, FLT_MAX);
+
+    std::vector<std::pair<float, int>> coarse(_lists);
+    for(auto l = 0; l < _lists; l++) {
+        coarse[l] = {clustering::squaredDistance(_coarse.data() + l * _dimension, query, _dimension), l};
+    }
+
+    probes = std::min(probes, _lists);
+    std::partial_sort(std::begin(coarse), std::begin(coarse) + probes, std::end(coarse));
+
+    std::vector<float> residual(_dimension);
+    std::vector<float> table(_subspaces * PQ_CENTROIDS);
+
+    for(auto p = 0; p < probes; p++) {
+        auto list = coarse[p].second;
+        if(_ids[list].empty()) continue;
+
+        const auto* centroid = _coarse.data() + list * _dimension;
+        for(auto j = 0; j < _dimension; j++) {
+            residual[j] = query[j] - centroid[j];
+        }
+
+        //asymmetric distance: the query residual is compared against every codeword once per list
+        for(auto m = 0; m < _subspaces; m++) {
+            const auto* codebook = _codebooks.data() + m * PQ_CENTROIDS * _subDimension;
+            for(auto c = 0; c < PQ_CENTROIDS; c++) {
+                table[m * PQ_CENTROIDS + c] = clustering::squaredDistance(codebook + c * _subDimension,
+                                                                          residual.data() + m * _subDimension,
+                                                                          _subDimension);
+            }
+        }
+
+        const auto* codes = _codes[list].data();
+        for(auto i = 0; i < _ids[list].size(); i++) {
+            const auto* code = codes + i * _subspaces;
+
+            auto distance = .0f;
+            for(auto m = 0; m < _subspaces; m++) {
+                distance += table[m * PQ_CENTROIDS + code[m]];
+            }
+
+            if(distance >= distances[k - 1]) continue;
+
+            auto position = k - 1;
+            for(; position > 0 && distances[position - 1] > distance; position--) {
+                distances[position] = distances[position - 1];
+                indices[position] = indices[position - 1];
+            }
+            distances[position] = distance;
+            indices[position] = _ids[list][i];
+        }
+    }
+}
+
+void descriptors::IvfPq::save(const std::string& path) const {
+    assert(trained());
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open()) throw std::runtime_error("ivfpq: cannot write " + path);
+
+    file.write(IVF_MAGIC, sizeof(IVF_MAGIC));
+    _write(file, &_dimension, 1);
+    _write(file, &_lists, 1);
+    _write(file, &_subspaces, 1);
+    _write(file, &_size, 1);
+    _write(file, _coarse.data(), _coarse.size());
+    _write(file, _codebooks.data(), _codebooks.size());
+
+    for(auto l = 0; l < _lists; l++) {
+        auto count = (int) _ids[l].size();
+        _write(file, &count, 1);
+        _write(file, _ids[l].data(), _ids[l].size());
+        _write(file, _codes[l].data(), _codes[l].size());
+    }
+
+    if(!file) throw std::runtime_error("ivfpq: cannot write " + path);
+}
+
+descriptors::IvfPq descriptors::IvfPq::load(const std::string& path) {
+    using namespace t_ivfpq;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open()) throw std::runtime_error("ivfpq: cannot open " + path);
+
+    auto fileSize = (std::uint64_t) file.tellg();
+    file.seekg(0);
+
+    char magic[sizeof(IVF_MAGIC)];
+    auto dimension = 0, lists = 0, subspaces = 0, size = 0;
+
+    file.read(magic, sizeof(magic));
+    _read(file, &dimension, 1);
+    _read(file, &lists, 1);
+    _read(file, &subspaces, 1);
+    _read(file, &size, 1);
+
+    if(!file || !std::equal(std::begin(magic), std::end(magic), std::begin(IVF_MAGIC))) {
+        throw std::runtime_error("ivfpq: " + path + " is not an ivfpq file");
+    }
+    if(dimension <= 0 || lists <= 0 || subspaces <= 0 || dimension % subspaces != 0 || size < 0) {
+        throw std::runtime_error("ivfpq: " + path + " has invalid dimensions");
+    }
+
+    //every size is checked against the rest of the file before it is allocated
+    auto remaining = fileSize - (std::uint64_t) file.tellg();
+    auto consume = [&](std::uint64_t bytes) {
+        if(bytes > remaining) throw std::runtime_error("ivfpq: " + path + " is truncated");
+        remaining -= bytes;
+    };
+
+    consume(sizeof(float) * ((std::uint64_t) lists * dimension + (std::uint64_t) PQ_CENTROIDS * dimension));
+
+    IvfPq index(dimension, lists, subspaces);
+    index._size = size;
+    index._coarse.resize(lists * dimension);
+    index._codebooks.resize(subspaces * PQ_CENTROIDS * index._subDimension);
+
+    _read(file, index._coarse.data(), index._coarse.size());
+    _read(file, index._codebooks.data(), index._codebooks.size());
+
+    auto total = (std::uint64_t) 0;
+    for(auto l = 0; l < lists; l++) {
+        auto count = 0;
+        consume(sizeof(count));
+        _read(file, &count, 1);
+
+        if(!file || count < 0 || (total += count) > (std::uint64_t) size) {
+            throw std::runtime_error("ivfpq: " + path + " has invalid list sizes");
+        }
+        consume((sizeof(int) + (std::uint64_t) subspaces) * count);
+
+        index._ids[l].resize(count);
+        index._codes[l].resize(count * subspaces);
+        _read(file, index._ids[l].data(), index._ids[l].size());
+        _read(file, index._codes[l].data(), index._codes[l].size());
+
+        if(std::any_of(std::begin(index._ids[l]), std::end(index._ids[l]), [size](int id) { return id < 0 || id >= size; })) {
+            throw std::runtime_error("ivfpq: " + path + " has invalid ids");
+        }
+    }
+
+    if(!file) throw std::runtime_error("ivfpq: " + path + " is truncated");
+    if(total != (std::uint64_t) size || remaining != 0) throw std::runtime_error("ivfpq: " + path + " has an unexpected size");
+
+    return index;
+}
+
+bool descriptors::IvfPq::trained() const {
+    return !_coarse.empty();
+}
+
+int descriptors::IvfPq::size() const {
+    return _size;
+}
+
+int descriptors::IvfPq::dimension() const {
+    return _dimension;
+}
+
+int descriptors::IvfPq::lists() const {
+    return _lists;
+}
+
+int descriptors::IvfPq::subspaces() const {
+    return _subspaces;
+}
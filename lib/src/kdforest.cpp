@@ -0,0 +1,179 @@
+#include <kdforest.h>
+
+#include <queue>
+
+using namespace pi;
+
+namespace {
+    struct _Branch {
+        float distance;
+        int tree;
+        int node;
+
+        bool operator>(const _Branch& branch) const {
+            return distance > branch.distance;
+        }
+    };
+}
+
+descriptors::KdForest::KdForest(const float* data, int count, int stride, int dimension, int trees, unsigned int seed)
+    : _dimension(dimension)
+    , _size(count)
+    , _data(count * dimension)
+    , _indices(trees)
+    , _trees(trees)
+{
+    assert(dimension > 0 && trees > 0);
+
+    for(auto i = 0; i < count; i++) {
+        std::copy(data + i * stride, data + i * stride + dimension, _data.data() + i * dimension);
+    }
+
+    std::mt19937 rand{seed};
+    for(auto t = 0; t < trees; t++) {
+        _indices[t].resize(count);
+        std::iota(std::begin(_indices[t]), std::end(_indices[t]), 0);
+
+        if(count > 0) {
+            _build(_trees[t], _indices[t], 0, count, rand);
+        }
+    }
+}
+
+int descriptors::KdForest::_build(std::vector<Node>& nodes, std::vector<int>& indices, int begin, int end,
+                                  std::mt19937& rand) {
+    using namespace t_kdforest;
+
+    auto id = (int) nodes.size();
+    nodes.push_back({-1, 0, begin, end});
+
+    if(end - begin <= KD_LEAF_SIZE) return id;
+
+    //split on a random one of the highest variance dimensions, estimated over a sample
+    auto samples = std::min(end - begin, KD_SAMPLES);
+    std::vector<double> mean(_dimension, .0), variance(_dimension, .0);
+
+    for(auto i = begin; i < begin + samples; i++) {
+        const auto* row = _data.data() + indices[i] * _dimension;
+        for(auto k = 0; k < _dimension; k++) {
+            mean[k] += row[k];
+        }
+    }
+    for(auto &value : mean) {
+        value /= samples;
+    }
+    for(auto i = begin; i < begin + samples; i++) {
+        const auto* row = _data.data() + indices[i] * _dimension;
+        for(auto k = 0; k < _dimension; k++) {
+            variance[k] += (row[k] - mean[k]) * (row[k] - mean[k]);
+        }
+    }
+
+    std::vector<int> dimensions(_dimension);
+    std::iota(std::begin(dimensions), std::end(dimensions), 0);
+
+    auto top = std::min(KD_RANDOM_DIMS, _dimension);
+    std::partial_sort(std::begin(dimensions), std::begin(dimensions) + top, std::end(dimensions),
+                      [&variance](int d1, int d2) {
+        return variance[d1] > variance[d2];
+    });
+
+    auto dimension = dimensions[std::uniform_int_distribution<int>(0, top - 1)(rand)];
+    auto value = (float) mean[dimension];
+
+    auto middle = std::partition(std::begin(indices) + begin, std::begin(indices) + end, [&](int index) {
+        return _data[index * _dimension + dimension] < value;
+    }) - std::begin(indices);
+
+    if(middle == begin || middle == end) {
+        middle = (begin + end) / 2;
+        std::nth_element(std::begin(indices) + begin, std::begin(indices) + middle, std::begin(indices) + end,
+                         [&](int index1, int index2) {
+            return _data[index1 * _dimension + dimension] < _data[index2 * _dimension + dimension];
+        });
+        value = _data[indices[middle] * _dimension + dimension];
+    }
+
+    auto left = _build(nodes, indices, begin, middle, rand);
+    auto right = _build(nodes, indices, middle, end, rand);
+    nodes[id] = {dimension, value, left, right};
+
+    return id;
+}
+
+void descriptors::KdForest::nearest2(const float* query, int* indices, float* distances, int checks) const {
+    indices[0] = indices[1] = -1;
+    distances[0] = distances[1] = FLT_MAX;
+
+    //visited points are stamped with a per-query generation, so the buffer is reused instead of cleared
+    thread_local std::vector<unsigned int> stamps;
+    thread_local unsigned int generation = 0;
+
+    if(stamps.size() < (std::size_t) _size) stamps.resize(_size, 0);
+    if(++generation == 0) {
+        std::fill(std::begin(stamps), std::end(stamps), 0);
+        generation = 1;
+    }
+    std::priority_queue<_Branch, std::vector<_Branch>, std::greater<>> branches;
+    auto counter = 0;
+
+    auto descend = [&](int tree, int id, float distance) {
+        const auto &nodes = _trees[tree];
+
+        while(nodes[id].dimension >= 0) {
+            const auto &node = nodes[id];
+            auto difference = query[node.dimension] - node.value;
+            auto near = difference < 0 ? node.left : node.right;
+            auto far = difference < 0 ? node.right : node.left;
+
+            branches.push({distance + difference * difference, tree, far});
+            id = near;
+        }
+
+        for(auto i = nodes[id].left; i < nodes[id].right; i++) {
+            auto index = _indices[tree][i];
+            if(stamps[index] == generation) continue;
+
+            stamps[index] = generation;
+            counter++;
+
+            auto distance = descriptors::distance(query, _data.data() + index * _dimension, _dimension);
+            if(distance < distances[0]) {
+                distances[1] = distances[0];
+                indices[1] = indices[0];
+                distances[0] = distance;
+                indices[0] = index;
+            } else if(distance < distances[1]) {
+                distances[1] = distance;
+                indices[1] = index;
+            }
+        }
+    };
+
+    if(_size == 0) return;
+
+    for(auto t = 0; t < _trees.size(); t++) {
+        descend(t, 0, .0f);
+    }
+
+    while(!branches.empty() && (counter < checks || indices[1] < 0)) {
+        auto branch = branches.top();
+        branches.pop();
+
+        if(branch.distance >= distances[1]) break;
+
+        descend(branch.tree, branch.node, branch.distance);
+    }
+}
+
+int descriptors::KdForest::size() const {
+    return _size;
+}
+
+int descriptors::KdForest::dimension() const {
+    return _dimension;
+}
+
+int descriptors::KdForest::trees() const {
+    return _trees.size();
+}
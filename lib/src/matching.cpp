@@ -0,0 +1,242 @@
+#include <matching.h>
+
+#include <cpu.h>
+
+#include <gsl/gsl_cblas.h>
+
+#ifdef PI_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+using namespace pi;
+
+namespace {
+    std::vector<float> _squaredNorms(const float* data, int count, int stride, int dimension) {
+        std::vector<float> norms(count);
+
+        for(auto i = 0; i < count; i++) {
+            const auto* row = data + i * stride;
+            norms[i] = std::inner_product(row, row + dimension, row, .0f);
+        }
+
+        return norms;
+    }
+
+    constexpr int MAX_LANES = 8;
+
+    using DistancesFunction = void (*)(const float* query, const float* block, int dimension, float* distances);
+
+    //distances from query to lanes interleaved train rows, every lane repeats
+    //descriptors::distance exactly: distance = float(double(distance) + double(d) * double(d))
+    void _distances(const float* query, const float* block, int dimension, float* distances) {
+        distances[0] = descriptors::distance(query, block, dimension);
+    }
+
+#ifdef PI_X86_DISPATCH
+    __attribute__((target("avx2")))
+    void _distancesAvx2(const float* query, const float* block, int dimension, float* distances) {
+        auto accumulator = _mm_setzero_ps();
+        for(auto k = 0; k < dimension; k++) {
+            auto difference = _mm256_cvtps_pd(_mm_sub_ps(_mm_set1_ps(query[k]), _mm_loadu_ps(block + k * 4)));
+            auto sum = _mm256_add_pd(_mm256_cvtps_pd(accumulator), _mm256_mul_pd(difference, difference));
+            accumulator = _mm256_cvtpd_ps(sum);
+        }
+        _mm_storeu_ps(distances, accumulator);
+    }
+
+    __attribute__((target("avx512f")))
+    void _distancesAvx512(const float* query, const float* block, int dimension, float* distances) {
+        auto accumulator = _mm256_setzero_ps();
+        for(auto k = 0; k < dimension; k++) {
+            auto difference = _mm512_cvtps_pd(_mm256_sub_ps(_mm256_set1_ps(query[k]), _mm256_loadu_ps(block + k * 8)));
+            auto sum = _mm512_add_pd(_mm512_cvtps_pd(accumulator), _mm512_mul_pd(difference, difference));
+            accumulator = _mm512_cvtpd_ps(sum);
+        }
+        _mm256_storeu_ps(distances, accumulator);
+    }
+#endif
+
+    //the widest kernel the cpu runs, with the number of train rows it takes at once
+    std::pair<DistancesFunction, int> _distancesKernel() {
+#ifdef PI_X86_DISPATCH
+        if(cpu::avx512f()) return {_distancesAvx512, 8};
+        if(cpu::avx2()) return {_distancesAvx2, 4};
+#endif
+        return {_distances, 1};
+    }
+}
+
+void descriptors::nearest2(const float* query, int queryCount, int queryStride,
+                           const float* train, int trainCount, int trainStride, int dimension,
+                           int* indices, float* distances) {
+    using namespace t_matching;
+
+    auto queryNorms = _squaredNorms(query, queryCount, queryStride, dimension);
+    auto trainNorms = _squaredNorms(train, trainCount, trainStride, dimension);
+    std::vector<float> products(M_BLOCK_ROWS * M_BLOCK_COLS);
+
+    std::fill(indices, indices + queryCount, 0);
+    std::fill(distances, distances + 2 * queryCount, FLT_MAX);
+
+    for(auto qBegin = 0; qBegin < queryCount; qBegin += M_BLOCK_ROWS) {
+        auto rows = std::min(M_BLOCK_ROWS, queryCount - qBegin);
+
+        for(auto tBegin = 0; tBegin < trainCount; tBegin += M_BLOCK_COLS) {
+            auto cols = std::min(M_BLOCK_COLS, trainCount - tBegin);
+
+            //block of A * B^T, |a - b|^2 = |a|^2 + |b|^2 - 2ab
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, rows, cols, dimension,
+                        -2.f, query + qBegin * queryStride, queryStride, train + tBegin * trainStride, trainStride,
+                        0.f, products.data(), cols);
+
+            for(auto i = 0; i < rows; i++) {
+                const auto* row = products.data() + i * cols;
+                auto queryNorm = queryNorms[qBegin + i];
+                auto* best = distances + 2 * (qBegin + i);
+                auto index = indices[qBegin + i];
+
+                for(auto j = 0; j < cols; j++) {
+                    auto distance = std::max(.0f, queryNorm + trainNorms[tBegin + j] + row[j]);
+
+                    if(distance < best[0]) {
+                        best[1] = best[0];
+                        best[0] = distance;
+                        index = tBegin + j;
+                    } else if(distance < best[1]) {
+                        best[1] = distance;
+                    }
+                }
+
+                indices[qBegin + i] = index;
+            }
+        }
+    }
+}
+
+void descriptors::mutualNearest2(const float* query, int queryCount, int queryStride,
+                                 const float* train, int trainCount, int trainStride, int dimension,
+                                 int* queryIndices, float* queryDistances, int* trainIndices, float* trainDistances) {
+    using namespace t_matching;
+
+    auto queryNorms = _squaredNorms(query, queryCount, queryStride, dimension);
+    auto trainNorms = _squaredNorms(train, trainCount, trainStride, dimension);
+    std::vector<float> products(M_BLOCK_ROWS * M_BLOCK_COLS);
+
+    std::fill(queryIndices, queryIndices + queryCount, 0);
+    std::fill(queryDistances, queryDistances + 2 * queryCount, FLT_MAX);
+    std::fill(trainIndices, trainIndices + trainCount, 0);
+    std::fill(trainDistances, trainDistances + 2 * trainCount, FLT_MAX);
+
+    for(auto qBegin = 0; qBegin < queryCount; qBegin += M_BLOCK_ROWS) {
+        auto rows = std::min(M_BLOCK_ROWS, queryCount - qBegin);
+
+        for(auto tBegin = 0; tBegin < trainCount; tBegin += M_BLOCK_COLS) {
+            auto cols = std::min(M_BLOCK_COLS, trainCount - tBegin);
+
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, rows, cols, dimension,
+                        -2.f, query + qBegin * queryStride, queryStride, train + tBegin * trainStride, trainStride,
+                        0.f, products.data(), cols);
+
+            //each distance of the block updates both the top-2 of its row and of its column
+            for(auto i = 0; i < rows; i++) {
+                const auto* row = products.data() + i * cols;
+                auto queryNorm = queryNorms[qBegin + i];
+                auto* best = queryDistances + 2 * (qBegin + i);
+                auto index = queryIndices[qBegin + i];
+
+                for(auto j = 0; j < cols; j++) {
+                    auto distance = std::max(.0f, queryNorm + trainNorms[tBegin + j] + row[j]);
+
+                    if(distance < best[0]) {
+                        best[1] = best[0];
+                        best[0] = distance;
+                        index = tBegin + j;
+                    } else if(distance < best[1]) {
+                        best[1] = distance;
+                    }
+
+                    auto* column = trainDistances + 2 * (tBegin + j);
+                    if(distance < column[0]) {
+                        column[1] = column[0];
+                        column[0] = distance;
+                        trainIndices[tBegin + j] = qBegin + i;
+                    } else if(distance < column[1]) {
+                        column[1] = distance;
+                    }
+                }
+
+                queryIndices[qBegin + i] = index;
+            }
+        }
+    }
+}
+
+void descriptors::bruteForceNearest2(const float* query, int queryCount, int queryStride,
+                                     const float* train, int trainCount, int trainStride, int dimension,
+                                     int* indices, float* distances, int threads) {
+    auto [kernel, lanes] = _distancesKernel();
+
+    //train rows are interleaved by lanes, so one load gives element k of lanes candidates
+    auto blocks = (trainCount + lanes - 1) / lanes;
+    std::vector<float> interleaved(blocks * dimension * lanes, .0f);
+
+    for(auto j = 0; j < trainCount; j++) {
+        auto* block = interleaved.data() + (j / lanes) * dimension * lanes + j % lanes;
+        for(auto k = 0; k < dimension; k++) {
+            block[k * lanes] = train[j * trainStride + k];
+        }
+    }
+
+    parallel::forEach(queryCount, threads, [&, kernel = kernel, lanes = lanes](int i) {
+        const auto* row = query + i * queryStride;
+        auto minDistance1 = FLT_MAX, minDistance2 = FLT_MAX;
+        auto index = 0;
+        float candidates[MAX_LANES];
+
+        for(auto b = 0; b < blocks; b++) {
+            kernel(row, interleaved.data() + b * dimension * lanes, dimension, candidates);
+
+            for(auto l = 0, size = std::min(lanes, trainCount - b * lanes); l < size; l++) {
+                auto distance = candidates[l];
+                if(distance < minDistance1) {
+                    minDistance2 = minDistance1;
+                    minDistance1 = distance;
+                    index = b * lanes + l;
+                } else if(distance < minDistance2) {
+                    minDistance2 = distance;
+                }
+            }
+        }
+
+        indices[i] = index;
+        distances[2 * i] = minDistance1;
+        distances[2 * i + 1] = minDistance2;
+    });
+}
+
+std::vector<descriptors::Match> descriptors::crossCheckMatchIndices(const float* query, int queryCount, int queryStride,
+                                                                   const float* train, int trainCount, int trainStride,
+                                                                   int dimension, float threshold) {
+    std::vector<Match> matches;
+    if(queryCount == 0 || trainCount == 0) return matches;
+
+    std::vector<int> queryIndices(queryCount), trainIndices(trainCount);
+    std::vector<float> queryDistances(2 * queryCount), trainDistances(2 * trainCount);
+
+    mutualNearest2(query, queryCount, queryStride, train, trainCount, trainStride, dimension,
+                   queryIndices.data(), queryDistances.data(), trainIndices.data(), trainDistances.data());
+
+    for(auto i = 0; i < queryCount; i++) {
+        auto j = queryIndices[i];
+        if(trainIndices[j] != i) continue;
+
+        auto ratio = queryDistances[2 * i] / queryDistances[2 * i + 1];
+        auto trainRatio = trainDistances[2 * j] / trainDistances[2 * j + 1];
+
+        if(ratio <= threshold && trainRatio <= threshold) {
+            matches.push_back({i, j, queryDistances[2 * i], ratio});
+        }
+    }
+
+    return matches;
+}
@@ -0,0 +1,152 @@
+#include <pca.h>
+
+#include <fstream>
+#include <stdexcept>
+
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_eigen.h>
+
+using namespace pi;
+
+namespace {
+    constexpr char PCA_MAGIC[4] = {'P', 'C', 'A', '1'};
+}
+
+descriptors::Pca descriptors::pca(const float* data, int count, int stride, int dimension, int components) {
+    assert(count > 1 && components > 0 && components <= dimension);
+
+    std::vector<double> mean(dimension, .0);
+    for(auto i = 0; i < count; i++) {
+        for(auto j = 0; j < dimension; j++) {
+            mean[j] += data[i * stride + j];
+        }
+    }
+    for(auto &value : mean) {
+        value /= count;
+    }
+
+    std::vector<double> centered(count * dimension);
+    for(auto i = 0; i < count; i++) {
+        for(auto j = 0; j < dimension; j++) {
+            centered[i * dimension + j] = data[i * stride + j] - mean[j];
+        }
+    }
+
+    std::vector<double> covariance(dimension * dimension);
+    std::vector<double> values(dimension);
+    std::vector<double> vectors(dimension * dimension);
+
+    auto X = gsl_matrix_view_array(centered.data(), count, dimension);
+    auto C = gsl_matrix_view_array(covariance.data(), dimension, dimension);
+    auto V = gsl_matrix_view_array(vectors.data(), dimension, dimension);
+    auto E = gsl_vector_view_array(values.data(), dimension);
+
+    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0 / (count - 1), &X.matrix, &X.matrix, 0.0, &C.matrix);
+
+    auto* workspace = gsl_eigen_symmv_alloc(dimension);
+    gsl_eigen_symmv(&C.matrix, &E.vector, &V.matrix, workspace);
+    gsl_eigen_symmv_free(workspace);
+    gsl_eigen_symmv_sort(&E.vector, &V.matrix, GSL_EIGEN_SORT_VAL_DESC);
+
+    //eigenvectors are the columns of V, the basis keeps one component per row
+    std::vector<float> basis(components * dimension);
+    for(auto k = 0; k < components; k++) {
+        for(auto j = 0; j < dimension; j++) {
+            basis[k * dimension + j] = vectors[j * dimension + k];
+        }
+    }
+
+    return Pca(dimension, components, std::vector<float>(std::begin(mean), std::end(mean)), std::move(basis));
+}
+
+descriptors::Pca::Pca(int dimension, int components, std::vector<float> mean, std::vector<float> basis)
+    : _dimension(dimension)
+    , _components(components)
+    , _mean(std::move(mean))
+    , _basis(std::move(basis))
+    , _offset(components, .0f)
+{
+    assert(_mean.size() == dimension && _basis.size() == components * dimension);
+
+    //(x - mean) * B^T == x * B^T - mean * B^T, the second term is the same for every row
+    for(auto k = 0; k < components; k++) {
+        for(auto j = 0; j < dimension; j++) {
+            _offset[k] += _basis[k * dimension + j] * _mean[j];
+        }
+    }
+}
+
+void descriptors::Pca::project(const float* src, int count, int srcStride, float* dst, int dstStride) const {
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, count, _components, _dimension,
+                1.f, src, srcStride, _basis.data(), _dimension, 0.f, dst, dstStride);
+
+    for(auto i = 0; i < count; i++) {
+        auto* row = dst + i * dstStride;
+        for(auto k = 0; k < _components; k++) {
+            row[k] -= _offset[k];
+        }
+    }
+}
+
+void descriptors::Pca::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open()) throw std::runtime_error("pca: cannot write " + path);
+
+    file.write(PCA_MAGIC, sizeof(PCA_MAGIC));
+    file.write(reinterpret_cast<const char*>(&_dimension), sizeof(_dimension));
+    file.write(reinterpret_cast<const char*>(&_components), sizeof(_components));
+    file.write(reinterpret_cast<const char*>(_mean.data()), sizeof(float) * _mean.size());
+    file.write(reinterpret_cast<const char*>(_basis.data()), sizeof(float) * _basis.size());
+}
+
+descriptors::Pca descriptors::Pca::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open()) throw std::runtime_error("pca: cannot open " + path);
+
+    auto fileSize = (std::uint64_t) file.tellg();
+    file.seekg(0);
+
+    char magic[sizeof(PCA_MAGIC)];
+    auto dimension = 0, components = 0;
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&dimension), sizeof(dimension));
+    file.read(reinterpret_cast<char*>(&components), sizeof(components));
+
+    if(!file || !std::equal(std::begin(magic), std::end(magic), std::begin(PCA_MAGIC))) {
+        throw std::runtime_error("pca: " + path + " is not a pca file");
+    }
+    if(dimension <= 0 || components <= 0 || components > dimension) {
+        throw std::runtime_error("pca: " + path + " has invalid dimensions");
+    }
+
+    //sizes are checked against the file before anything is allocated
+    auto header = sizeof(magic) + sizeof(dimension) + sizeof(components);
+    auto payload = sizeof(float) * ((std::uint64_t) dimension + (std::uint64_t) components * dimension);
+    if(fileSize != header + payload) throw std::runtime_error("pca: " + path + " has an unexpected size");
+
+    std::vector<float> mean(dimension);
+    std::vector<float> basis(components * dimension);
+
+    file.read(reinterpret_cast<char*>(mean.data()), sizeof(float) * mean.size());
+    file.read(reinterpret_cast<char*>(basis.data()), sizeof(float) * basis.size());
+    if(!file) throw std::runtime_error("pca: " + path + " is truncated");
+
+    return Pca(dimension, components, std::move(mean), std::move(basis));
+}
+
+const std::vector<float>& descriptors::Pca::mean() const {
+    return _mean;
+}
+
+const std::vector<float>& descriptors::Pca::basis() const {
+    return _basis;
+}
+
+int descriptors::Pca::dimension() const {
+    return _dimension;
+}
+
+int descriptors::Pca::components() const {
+    return _components;
+}
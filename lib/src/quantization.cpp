@@ -0,0 +1,56 @@
+#include <quantization.h>
+#include <cpu.h>
+
+#ifdef PI_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+using namespace pi;
+
+namespace {
+    int _distance(const std::uint8_t* descriptor1, const std::uint8_t* descriptor2, int begin, int size) {
+        auto distance = 0;
+        for(auto i = begin; i < size; i++) {
+            auto difference = (int) descriptor1[i] - descriptor2[i];
+            distance += difference * difference;
+        }
+
+        return distance;
+    }
+
+#ifdef PI_X86_DISPATCH
+    __attribute__((target("avx2")))
+    int _distanceAvx2(const std::uint8_t* descriptor1, const std::uint8_t* descriptor2, int size) {
+        auto i = 0;
+
+        //widen to 16 bits, square and add pairs with madd into 8 int32 lanes
+        auto accumulator = _mm256_setzero_si256();
+        for(; i + 16 <= size; i += 16) {
+            auto a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor1 + i)));
+            auto b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor2 + i)));
+            auto difference = _mm256_sub_epi16(a, b);
+            accumulator = _mm256_add_epi32(accumulator, _mm256_madd_epi16(difference, difference));
+        }
+
+        auto sum = _mm_add_epi32(_mm256_castsi256_si128(accumulator), _mm256_extracti128_si256(accumulator, 1));
+        sum = _mm_hadd_epi32(sum, sum);
+        sum = _mm_hadd_epi32(sum, sum);
+
+        return _mm_cvtsi128_si32(sum) + _distance(descriptor1, descriptor2, i, size);
+    }
+#endif
+}
+
+void descriptors::quantize(std::uint8_t* quantized, const float* descriptor, int size, float scale) {
+    for(auto i = 0; i < size; i++) {
+        quantized[i] = (std::uint8_t) std::clamp(std::lround(descriptor[i] * scale), 0l, 255l);
+    }
+}
+
+int descriptors::distance(const std::uint8_t* descriptor1, const std::uint8_t* descriptor2, int size) {
+#ifdef PI_X86_DISPATCH
+    if(cpu::avx2()) return _distanceAvx2(descriptor1, descriptor2, size);
+#endif
+
+    return _distance(descriptor1, descriptor2, 0, size);
+}
@@ -0,0 +1,111 @@
+#include <storage.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <limits>
+#include <system_error>
+
+using namespace pi;
+
+descriptors::MappedFile::MappedFile(const std::string& path)
+    : _data(nullptr)
+    , _size(0)
+{
+    auto fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw std::system_error(errno, std::generic_category(), "storage: cannot open " + path);
+
+    struct stat info{};
+    if(fstat(fd, &info) != 0) {
+        auto error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "storage: cannot stat " + path);
+    }
+    _size = info.st_size;
+
+    if(_size > 0) {
+        auto* data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        if(data == MAP_FAILED) {
+            auto error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "storage: cannot map " + path);
+        }
+        _data = data;
+    }
+
+    close(fd);
+}
+
+descriptors::MappedFile::MappedFile(MappedFile&& file) noexcept
+    : _data(file._data)
+    , _size(file._size)
+{
+    file._data = nullptr;
+    file._size = 0;
+}
+
+descriptors::MappedFile& descriptors::MappedFile::operator=(MappedFile&& file) noexcept {
+    if(this != &file) {
+        if(_data != nullptr) {
+            munmap(_data, _size);
+        }
+
+        _data = file._data;
+        _size = file._size;
+
+        file._data = nullptr;
+        file._size = 0;
+    }
+    return *this;
+}
+
+const std::uint8_t* descriptors::MappedFile::data() const {
+    return static_cast<const std::uint8_t*>(_data);
+}
+
+std::size_t descriptors::MappedFile::size() const {
+    return _size;
+}
+
+descriptors::MappedFile::~MappedFile() {
+    if(_data != nullptr) {
+        munmap(_data, _size);
+    }
+}
+
+void descriptors::validate(const std::uint8_t* data, std::size_t size, std::uint32_t pointType, std::uint32_t pointSize,
+                           std::uint32_t valueType, std::uint32_t valueSize) {
+    using namespace t_storage;
+
+    auto fail = [](const std::string& reason) {
+        throw std::runtime_error("storage: " + reason);
+    };
+
+    if(data == nullptr || size < sizeof(FeatureHeader)) fail("file is smaller than the header");
+
+    const auto &header = *reinterpret_cast<const FeatureHeader*>(data);
+
+    if(!std::equal(std::begin(header.magic), std::end(header.magic), std::begin(F_MAGIC))) fail("not a feature file");
+    if(header.version != F_VERSION) fail("unsupported version " + std::to_string(header.version));
+    if(header.pointType != pointType || header.pointSize != pointSize) fail("point type mismatch");
+    if(header.valueType != valueType) fail("value type mismatch");
+    if(header.dimension == 0 || header.stride < header.dimension) fail("invalid dimension or stride");
+    if(header.count > (std::uint64_t) std::numeric_limits<int>::max()) fail("too many descriptors");
+
+    //every bound is checked by division, so count * stride can not overflow
+    auto fits = [size](std::uint64_t offset, std::uint64_t count, std::uint64_t itemSize) {
+        return offset <= size && (count == 0 || (size - offset) / itemSize >= count);
+    };
+
+    if(header.pointsOffset < sizeof(FeatureHeader) || header.pointsOffset % F_ALIGNMENT != 0
+       || !fits(header.pointsOffset, header.count, pointSize)) {
+        fail("points are out of the file");
+    }
+    if(header.dataOffset < header.pointsOffset + header.count * pointSize || header.dataOffset % F_ALIGNMENT != 0
+       || !fits(header.dataOffset, header.count, (std::uint64_t) header.stride * valueSize)) {
+        fail("descriptors are out of the file");
+    }
+}
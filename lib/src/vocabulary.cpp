@@ -0,0 +1,179 @@
+#include <vocabulary.h>
+
+#include <unordered_map>
+
+using namespace pi;
+
+namespace {
+    float _total(const std::vector<std::pair<int, int>>& histogram) {
+        return std::accumulate(std::begin(histogram), std::end(histogram), 0, [](auto sum, const auto& bin) {
+            return sum + bin.second;
+        });
+    }
+}
+
+descriptors::VocabularyTree::VocabularyTree(const float* data, int count, int stride, int dimension,
+                                             int branching, int depth, unsigned int seed)
+    : _dimension(dimension)
+    , _branching(branching)
+    , _words(0)
+{
+    assert(count > 0 && branching > 1 && depth > 0);
+
+    std::vector<int> indices(count);
+    std::iota(std::begin(indices), std::end(indices), 0);
+
+    std::mt19937 rand{seed};
+    _nodes.push_back({-1, 0, -1});
+    _centroids.resize(dimension);
+    _build(0, data, stride, indices, depth, rand);
+
+    _inverted.resize(_words);
+}
+
+void descriptors::VocabularyTree::_build(int id, const float* data, int stride, const std::vector<int>& indices,
+                                         int depth, std::mt19937& rand) {
+    if(depth == 0 || indices.size() <= _branching) {
+        _nodes[id].word = _words++;
+        return;
+    }
+
+    std::vector<int> labels;
+    auto centroids = clustering::kmeans(data, stride, _dimension, indices, _branching, rand, labels);
+    auto children = (int) centroids.size() / _dimension;
+    auto first = (int) _nodes.size();
+
+    _nodes[id].children = first;
+    _nodes[id].count = children;
+    _nodes.resize(first + children, {-1, 0, -1});
+    _centroids.insert(std::end(_centroids), std::begin(centroids), std::end(centroids));
+
+    std::vector<std::vector<int>> subsets(children);
+    for(auto i = 0; i < indices.size(); i++) {
+        subsets[labels[i]].push_back(indices[i]);
+    }
+
+    for(auto c = 0; c < children; c++) {
+        if(subsets[c].empty()) {
+            _nodes[first + c].word = _words++;
+        } else {
+            _build(first + c, data, stride, subsets[c], depth - 1, rand);
+        }
+    }
+}
+
+int descriptors::VocabularyTree::word(const float* descriptor) const {
+    auto id = 0;
+    while(_nodes[id].children >= 0) {
+        const auto &node = _nodes[id];
+        id = node.children + clustering::nearest(_centroids.data() + node.children * _dimension, node.count,
+                                                 _dimension, descriptor);
+    }
+
+    return _nodes[id].word;
+}
+
+std::vector<std::pair<int, int>> descriptors::VocabularyTree::_histogram(const float* data, int count, int stride) const {
+    std::vector<int> words(count);
+    for(auto i = 0; i < count; i++) {
+        words[i] = word(data + i * stride);
+    }
+    std::sort(std::begin(words), std::end(words));
+
+    std::vector<std::pair<int, int>> histogram;
+    for(auto word : words) {
+        if(histogram.empty() || histogram.back().first != word) {
+            histogram.emplace_back(word, 0);
+        }
+        histogram.back().second++;
+    }
+
+    return histogram;
+}
+
+float descriptors::VocabularyTree::_idf(int word) const {
+    auto documents = _inverted[word].size();
+
+    return documents == 0 ? .0f : std::log((float) _images.size() / documents);
+}
+
+//squared tf-idf norm is sum tf^2 * (log N - log df)^2, it is kept expanded in powers of log N,
+//so a new image only updates the images sharing its words while N is applied on demand
+float descriptors::VocabularyTree::_norm(int image) const {
+    const auto &norm = _norms[image];
+    auto logN = std::log((double) _images.size());
+
+    return (float) std::sqrt(std::max(.0, norm.squares * logN * logN - 2 * norm.logs * logN + norm.squaredLogs));
+}
+
+int descriptors::VocabularyTree::add(const float* data, int count, int stride) {
+    auto image = (int) _images.size();
+
+    _images.push_back(_histogram(data, count, stride));
+    _totals.push_back(_total(_images.back()));
+    _norms.push_back({.0, .0, .0});
+
+    for(const auto &bin : _images.back()) {
+        auto &postings = _inverted[bin.first];
+        auto oldLog = postings.empty() ? .0 : std::log((double) postings.size());
+        auto newLog = std::log((double) postings.size() + 1);
+
+        postings.emplace_back(image, bin.second);
+        for(auto i = 0; i < postings.size(); i++) {
+            auto tf = (double) postings[i].second / _totals[postings[i].first];
+            auto &norm = _norms[postings[i].first];
+            auto fresh = i + 1 == postings.size();
+
+            norm.squares += fresh ? tf * tf : .0;
+            norm.logs += tf * tf * (fresh ? newLog : newLog - oldLog);
+            norm.squaredLogs += tf * tf * (fresh ? newLog * newLog : newLog * newLog - oldLog * oldLog);
+        }
+    }
+
+    return image;
+}
+
+std::vector<std::pair<int, float>> descriptors::VocabularyTree::query(const float* data, int count, int stride,
+                                                                      int shortlist) const {
+    auto histogram = _histogram(data, count, stride);
+    auto total = _total(histogram);
+
+    //tf-idf cosine similarity, only images sharing a word with the query are scored
+    auto queryNorm = .0f;
+    std::unordered_map<int, float> products;
+
+    for(const auto &bin : histogram) {
+        auto idf = _idf(bin.first);
+        auto weight = bin.second / total * idf;
+        queryNorm += weight * weight;
+
+        for(const auto &posting : _inverted[bin.first]) {
+            products[posting.first] += weight * posting.second / _totals[posting.first] * idf;
+        }
+    }
+
+    std::vector<std::pair<int, float>> scores;
+    for(const auto &product : products) {
+        auto imageNorm = _norm(product.first);
+
+        if(imageNorm > 0 && queryNorm > 0) {
+            scores.emplace_back(product.first, product.second / (imageNorm * std::sqrt(queryNorm)));
+        }
+    }
+
+    auto size = std::min<int>(shortlist, scores.size());
+    std::partial_sort(std::begin(scores), std::begin(scores) + size, std::end(scores), [](const auto& s1, const auto& s2) {
+        return s1.second > s2.second || (s1.second == s2.second && s1.first < s2.first);
+    });
+    scores.resize(size);
+
+    return scores;
+}
+
+int descriptors::VocabularyTree::words() const {
+    return _words;
+}
+
+int descriptors::VocabularyTree::images() const {
+    return _images.size();
+}
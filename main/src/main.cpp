@@ -69,9 +69,7 @@ void l3() {
                         utils::load("/home/alexander/Lenna.png")));
 
     auto moravecImage = utils::addPointsTo(image,
-                            detectors::adaptiveNonMaximumSuppresion(
-                                detectors::moravec(image), 300,
-                                utils::radius(image), utils::euclidDistance));
+                            detectors::adaptiveNonMaximumSuppresion(detectors::moravec(image), 300));
     utils::render("moravec", moravecImage);
     utils::save("../examples/lr3/moravec300points", moravecImage);
 
@@ -106,8 +104,8 @@ void l4() {
 }
 
 void l5() {
-    auto normalize = [](const auto& descriptor) {
-        return descriptors::normalize(descriptors::trim(descriptors::normalize(descriptor)));
+    auto normalize = [](auto& set) {
+        descriptors::siftNormalize(set);
     };
 
     auto image1 = opts::normalize(
@@ -120,10 +118,10 @@ void l5() {
 
     auto matchImage = utils::drawMatches(image2, image1,
                                          descriptors::match<detectors::Point>(
-                                                descriptors::riDescriptors(detectors::harris(image2, 5, .015f),
+                                                descriptors::riDescriptorSet(detectors::harris(image2, 5, .015f),
                                                      filters::sobel(image2, borders::BORDER_REFLECT),
                                                      normalize),
-                                                descriptors::riDescriptors(detectors::harris(image1, 5, .015f),
+                                                descriptors::riDescriptorSet(detectors::harris(image1, 5, .015f),
                                                      filters::sobel(image1, borders::BORDER_REFLECT),
                                                      normalize), .55f));
     utils::render("matches", matchImage);
@@ -131,8 +129,8 @@ void l5() {
 }
 
 void l6() {
-    auto normalize = [](const auto& descriptor) {
-        return descriptors::normalize(descriptors::trim(descriptors::normalize(descriptor)));
+    auto normalize = [](auto& set) {
+        descriptors::siftNormalize(set);
     };
 
     auto image1 = opts::normalize(
@@ -154,12 +152,12 @@ void l6() {
 
     auto matchImage = utils::drawMatches(mImage2, mImage1,
                                           descriptors::match<detectors::Point>(
-                                                 descriptors::siDescriptors(points2, gpyramid2, normalize
+                                                 descriptors::siDescriptorSet(points2, gpyramid2, normalize
                                                                             , descriptors::D_HISTO_SIZE
                                                                             , descriptors::D_HISTO_NUMS
                                                                             , descriptors::D_BINS
                                                                             , borders::BORDER_REPLICATE, false),
-                                                 descriptors::siDescriptors(points1, gpyramid1, normalize
+                                                 descriptors::siDescriptorSet(points1, gpyramid1, normalize
                                                                             , descriptors::D_HISTO_SIZE
                                                                             , descriptors::D_HISTO_NUMS
                                                                             , descriptors::D_BINS
@@ -171,8 +169,8 @@ void l6() {
 }
 
 void l7() {
-    auto normalize = [](const auto& descriptor) {
-        return descriptors::normalize(descriptors::trim(descriptors::normalize(descriptor)));
+    auto normalize = [](auto& set) {
+        descriptors::siftNormalize(set);
     };
 
     auto image1 = opts::normalize(
@@ -194,8 +192,8 @@ void l7() {
 
     auto matchImage = utils::drawMatches(mImage2, mImage1,
                                           descriptors::match<detectors::Point>(
-                                                 descriptors::siDescriptors(points2, gpyramid2, normalize)
-                                                 , descriptors::siDescriptors(points1, gpyramid1, normalize)
+                                                 descriptors::siDescriptorSet(points2, gpyramid2, normalize)
+                                                 , descriptors::siDescriptorSet(points1, gpyramid1, normalize)
                                                  , .62f));
 
     utils::render("matches", matchImage);
@@ -203,8 +201,8 @@ void l7() {
 }
 
 void l8() {
-    auto normalize = [](const auto& descriptor) {
-        return descriptors::normalize(descriptors::trim(descriptors::normalize(descriptor)));
+    auto normalize = [](auto& set) {
+        descriptors::siftNormalize(set);
     };
 
     auto image1 = opts::normalize(
@@ -219,16 +217,17 @@ void l8() {
     auto gpyramid2 = pyramids::gpyramid(image2, 3, 3, pyramids::logOctavesCount);
     auto dog2 = pyramids::dog(gpyramid2);
 
-    auto transform2d = transforms::homography(descriptors::match<detectors::Point>(
-                                                     descriptors::siDescriptors(
-                                                            detectors::shiTomasi(dog2, detectors::blobs(dog2)
-                                                                                 , 25e-5f)
-                                                            , gpyramid2, normalize)
-                                                     , descriptors::siDescriptors(
-                                                            detectors::shiTomasi(dog1, detectors::blobs(dog1)
-                                                                                 , 25e-5f)
-                                                            , gpyramid1, normalize)
-                                                     , .62f));
+    auto set1 = descriptors::siDescriptorSet(detectors::shiTomasi(dog1, detectors::blobs(dog1), 25e-5f)
+                                             , gpyramid1, normalize);
+    auto set2 = descriptors::siDescriptorSet(detectors::shiTomasi(dog2, detectors::blobs(dog2), 25e-5f)
+                                             , gpyramid2, normalize);
+
+    auto matches = descriptors::matchIndices(set2, set1, .62f);
+    std::stable_sort(std::begin(matches), std::end(matches), [](const auto& m1, const auto& m2) {
+        return m1.ratio < m2.ratio;
+    });
+
+    auto transform2d = transforms::prosacHomography(descriptors::resolve<detectors::Point>(matches, set2, set1));
 
     auto width = image1.width() + image2.width();
     auto height = image1.height() + image2.height();
@@ -241,8 +240,8 @@ void l8() {
 }
 
 void l9() {
-    auto normalize = [](const auto& descriptor) {
-        return descriptors::normalize(descriptors::trim(descriptors::normalize(descriptor)));
+    auto normalize = [](auto& set) {
+        descriptors::siftNormalize(set);
     };
 
     auto image1 = opts::normalize(
@@ -259,11 +258,11 @@ void l9() {
 
     auto transform2d = transforms::hough(image1.dimensions(), image2.dimensions()
                                          , descriptors::match<detectors::SPoint>(
-                                             descriptors::siDescriptors(
-                                                 detectors::shiTomasi(dog2, detectors::blobs(dog2), 1e-5f)
+                                             descriptors::siDescriptorSet(
+                                                 detectors::shiTomasi(dog2, detectors::blobs(dog2), {2000, 8}, 1e-5f)
                                                  , gpyramid2, normalize)
-                                             , descriptors::siDescriptors(
-                                                 detectors::shiTomasi(dog1, detectors::blobs(dog1), 1e-5f)
+                                             , descriptors::siDescriptorSet(
+                                                 detectors::shiTomasi(dog1, detectors::blobs(dog1), {2000, 8}, 1e-5f)
                                                  , gpyramid1, normalize)
                                              ));
 